@@ -26,15 +26,9 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "actionview.h"
-#ifdef HAVE_MENU_CACHE
-    #include "xdgcachedmenu.h"
-#else
-    #include <XdgAction>
-#endif
-
-#include <QAction>
-#include <QWidgetAction>
-#include <QMenu>
+#include "menusearchindex.h"
+#include "menuiconloader.h"
+
 #include <QStandardItemModel>
 #include <QScrollBar>
 #include <QProxyStyle>
@@ -44,42 +38,14 @@
 #include <QMouseEvent>
 #include <QMimeData>
 #include <QUrl>
+#include <XdgDesktopFile>
 
-//==============================
-#ifdef HAVE_MENU_CACHE
-#include <QSortFilterProxyModel>
-#else
-FilterProxyModel::FilterProxyModel(QObject* parent) :
-    QSortFilterProxyModel(parent) {
-}
-
-FilterProxyModel::~FilterProxyModel() = default;
-
-bool FilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const {
-    if (filterStr_.isEmpty())
-        return true;
-    if (QStandardItemModel* srcModel = static_cast<QStandardItemModel*>(sourceModel())) {
-        QModelIndex index = srcModel->index(source_row, 0, source_parent);
-        if (QStandardItem * item = srcModel->itemFromIndex(index)) {
-            XdgAction * action = qobject_cast<XdgAction *>(qvariant_cast<QAction *>(item->data(ActionView::ActionRole)));
-            if (action) {
-                const XdgDesktopFile& df = action->desktopFile();
-                if (df.name().contains(filterStr_, filterCaseSensitivity()))
-                    return true;
-                QStringList list = df.expandExecString();
-                if (!list.isEmpty()) {
-                    if (list.at(0).contains(filterStr_, filterCaseSensitivity()))
-                        return true;
-                }
-            }
-        }
-    }
-    return false;
-}
-#endif
 //==============================
 namespace
 {
+    // upper bound of the ranked search results
+    constexpr int MAX_RESULTS = 100;
+
     class SingleActivateStyle : public QProxyStyle
     {
     public:
@@ -106,35 +72,31 @@ namespace
             mMaxItemWidth = max;
         }
 
+        void setIconLoader(MenuIconLoader * loader)
+        {
+            mIconLoader = loader;
+        }
+
         QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override
         {
             QIcon icon = index.data(Qt::DecorationRole).value<QIcon>();
-            //the XdgCachedMenuAction/XdgAction does load the icon upon showing its menu
-#ifdef HAVE_MENU_CACHE
-            if (icon.isNull())
-            {
-                XdgCachedMenuAction * cached_action = qobject_cast<XdgCachedMenuAction *>(qvariant_cast<QAction *>(index.data(ActionView::ActionRole)));
-                Q_ASSERT(nullptr != cached_action);
-                cached_action->updateIcon();
-                const_cast<QAbstractItemModel *>(index.model())->setData(index, cached_action->icon(), Qt::DecorationRole);
-            }
-#else
-            if (icon.isNull())
+            //the icons are loaded upon showing the item (set by the ActionView::onIconLoaded()
+            //if not loaded yet)
+            if (icon.isNull() && nullptr != mIconLoader)
             {
-                XdgAction * action = qobject_cast<XdgAction *>(qvariant_cast<QAction *>(index.data(ActionView::ActionRole)));
-                if (action != nullptr)
-                {
-                  action->updateIcon();
-                  const_cast<QAbstractItemModel *>(index.model())->setData(index, action->icon(), Qt::DecorationRole);
-                }
+                icon = mIconLoader->icon(index.data(ActionView::IconNameRole).toString());
+                // checking null prevents infinite recursion
+                // (setData->dataChanged->sizeHint->setData)
+                if (!icon.isNull())
+                    const_cast<QAbstractItemModel *>(index.model())->setData(index, icon, Qt::DecorationRole);
             }
-#endif
             QSize s = QStyledItemDelegate::sizeHint(option, index);
             s.setWidth(qMin(mMaxItemWidth, s.width()));
             return s;
         }
     private:
         int mMaxItemWidth{300};
+        MenuIconLoader * mIconLoader{nullptr};
     };
 
 }
@@ -142,11 +104,7 @@ namespace
 ActionView::ActionView(QWidget * parent /*= nullptr*/)
     : QListView(parent)
     , mModel{new QStandardItemModel{this}}
-#ifdef HAVE_MENU_CACHE
-    , mProxy{new QSortFilterProxyModel{this}}
-#else
-    , mProxy{new FilterProxyModel{this}}
-#endif
+    , mSearchIndex{nullptr}
     , mMaxItemsToShow(10)
 {
     setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -158,14 +116,9 @@ ActionView::ActionView(QWidget * parent /*= nullptr*/)
     SingleActivateStyle * s = new SingleActivateStyle;
     s->setParent(this);
     setStyle(s);
-    mProxy->setSourceModel(mModel);
-    mProxy->setDynamicSortFilter(true);
-    mProxy->setFilterRole(FilterRole);
-    mProxy->setFilterCaseSensitivity(Qt::CaseInsensitive);
-    mProxy->sort(0);
     {
         QScopedPointer<QItemSelectionModel> guard{selectionModel()};
-        setModel(mProxy);
+        setModel(mModel);
     }
     {
         QScopedPointer<QAbstractItemDelegate> guard{itemDelegate()};
@@ -176,74 +129,63 @@ ActionView::ActionView(QWidget * parent /*= nullptr*/)
 
 void ActionView::ActionView::clear()
 {
-    for (int i = mModel->rowCount() - 1; i >= 0; --i)
-    {
-        mModel->removeRow(i);
-    }
+    mModel->removeRows(0, mModel->rowCount());
 }
 
-void ActionView::addAction(QAction * action)
+void ActionView::setSearchIndex(MenuSearchIndex const * index)
 {
-    QStandardItem * item = new QStandardItem;
-    item->setData(QVariant::fromValue<QAction *>(action), ActionRole);
-    item->setFont(action->font());
-    //Note: XdgCachedMenuAction has delayed icon loading... we are loading the icon
-    //in QStyledItemDelegate:sizeHint if necessary
-    item->setIcon(action->icon());
-    item->setText(action->text());
-    item->setToolTip(action->toolTip());
-    QString all = action->text();
-    all += QLatin1Char('\n');
-    all += action->toolTip();
-    item->setData(all, FilterRole);
-
-    mModel->appendRow(item);
-    connect(action, &QObject::destroyed, this, &ActionView::onActionDestroyed);
+    mSearchIndex = index;
 }
 
-bool ActionView::existsAction(QAction const * action) const
+void ActionView::setIconLoader(MenuIconLoader * loader)
 {
-    bool exists = false;
-    for (int row = mModel->rowCount() - 1; 0 <= row; --row)
-    {
-        const QModelIndex index = mModel->index(row, 0);
-        if (action->text() == mModel->data(index, Qt::DisplayRole)
-                && action->toolTip() == mModel->data(index, Qt::ToolTipRole)
-                )
-        {
-            exists = true;
-            break;
-        }
-
-    }
-    return exists;
-}
-
-void ActionView::fillActions(QMenu * menu)
-{
-    clear();
-    fillActionsRecursive(menu);
+    dynamic_cast<DelayedIconDelegate *>(itemDelegate())->setIconLoader(loader);
+    connect(loader, &MenuIconLoader::iconLoaded, this, &ActionView::onIconLoaded);
+    connect(loader, &MenuIconLoader::iconsReset, this, &ActionView::onIconsReset);
 }
 
 void ActionView::setFilter(QString const & filter)
 {
-#ifdef HAVE_MENU_CACHE
-    mProxy->setFilterFixedString(filter);
-#else
-    mProxy->setfilerString(filter);
-#endif
-    const int count = mProxy->rowCount();
-    if (0 < count)
+    if (nullptr == mSearchIndex)
+    {
+        clear();
+        return;
+    }
+
+    // the rows of the same application are kept (usually the best matches
+    // don't change as the filter grows), the others are replaced
+    const QVector<int> ranked = mSearchIndex->rank(filter, MAX_RESULTS);
+    for (int row = 0, row_e = ranked.size(); row < row_e; ++row)
     {
-        if (count > mMaxItemsToShow)
+        MenuSearchIndex::Entry const & entry = mSearchIndex->entry(ranked.at(row));
+        QStandardItem * item = mModel->item(row);
+        if (nullptr == item || item->data(DesktopFileRole).toString() != entry.id)
         {
-            setCurrentIndex(mProxy->index(mMaxItemsToShow - 1, 0));
-            verticalScrollBar()->triggerAction(QScrollBar::SliderToMinimum);
-        } else
+            item = new QStandardItem;
+            item->setData(entry.id, DesktopFileRole);
+            if (row < mModel->rowCount())
+                mModel->setItem(row, item);
+            else
+                mModel->appendRow(item);
+        }
+        //Note: we are loading the icon in QStyledItemDelegate:sizeHint if necessary
+        //Note: the QStandardItem doesn't signal setting of an unchanged value
+        item->setText(entry.title);
+        item->setToolTip(entry.toolTip);
+        if (item->data(IconNameRole).toString() != entry.icon)
         {
-            setCurrentIndex(mProxy->index(count - 1, 0));
+            item->setData(entry.icon, IconNameRole);
+            item->setData(QVariant{}, Qt::DecorationRole);
         }
     }
+    if (ranked.size() < mModel->rowCount())
+        mModel->removeRows(ranked.size(), mModel->rowCount() - ranked.size());
+    if (0 < mModel->rowCount())
+    {
+        // the best match
+        setCurrentIndex(mModel->index(0, 0));
+        verticalScrollBar()->triggerAction(QScrollBar::SliderToMinimum);
+    }
 }
 
 void ActionView::setMaxItemsToShow(int max)
@@ -265,7 +207,7 @@ void ActionView::activateCurrent()
 
 QSize ActionView::viewportSizeHint() const
 {
-    const int count = mProxy->rowCount();
+    const int count = mModel->rowCount();
     QSize s{0, 0};
     if (0 < count)
     {
@@ -297,12 +239,12 @@ void ActionView::mouseMoveEvent(QMouseEvent *event)
     if ((event->pos() - mDragStartPosition).manhattanLength() < QApplication::startDragDistance())
         return;
 
-    XdgAction *a = qobject_cast<XdgAction*>(indexAt(mDragStartPosition).data(ActionView::ActionRole).value<QAction*>());
-    if (!a)
+    const QString file = indexAt(mDragStartPosition).data(DesktopFileRole).toString();
+    if (file.isEmpty())
         return;
 
     QList<QUrl> urls;
-    urls << QUrl::fromLocalFile(a->desktopFile().fileName());
+    urls << QUrl::fromLocalFile(file);
 
     QMimeData *mimeData = new QMimeData();
     mimeData->setUrls(urls);
@@ -315,41 +257,25 @@ void ActionView::mouseMoveEvent(QMouseEvent *event)
 
 void ActionView::onActivated(QModelIndex const & index)
 {
-    QAction * action = qvariant_cast<QAction *>(model()->data(index, ActionRole));
-    Q_ASSERT(nullptr != action);
-    action->trigger();
+    XdgDesktopFile df;
+    if (df.load(index.data(DesktopFileRole).toString()))
+        df.startDetached();
 }
 
-void ActionView::onActionDestroyed()
+void ActionView::onIconLoaded(QString const & name, QIcon const & icon)
 {
-    QObject * const action = sender();
-    Q_ASSERT(nullptr != action);
     for (int i = mModel->rowCount() - 1; 0 <= i; --i)
     {
         QStandardItem * item = mModel->item(i);
-        if (action == item->data(ActionRole).value<QObject *>())
-        {
-            mModel->removeRow(i);
-            break;
-        }
+        if (item->data(IconNameRole).toString() == name && item->icon().isNull())
+            item->setIcon(icon);
     }
 }
 
-void ActionView::fillActionsRecursive(QMenu * menu)
+void ActionView::onIconsReset()
 {
-    const auto actions = menu->actions();
-    for (auto const & action : actions)
-    {
-        if (QMenu * sub_menu = action->menu())
-        {
-            fillActionsRecursive(sub_menu); //recursion
-        } else if (nullptr == qobject_cast<QWidgetAction* >(action)
-                && !action->isSeparator())
-        {
-            //real menu action -> app
-            if (!existsAction(action))
-                addAction(action);
-        }
-    }
+    // the icons are requested again by the DelayedIconDelegate::sizeHint()
+    for (int i = mModel->rowCount() - 1; 0 <= i; --i)
+        mModel->item(i)->setData(QVariant{}, Qt::DecorationRole);
+    scheduleDelayedItemsLayout();
 }
-
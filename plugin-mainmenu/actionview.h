@@ -30,33 +30,12 @@
 
 #include <QListView>
 #include <QPoint>
+#include <QIcon>
 
 class QStandardItemModel;
+class MenuSearchIndex;
+class MenuIconLoader;
 
-//==============================
-#ifdef HAVE_MENU_CACHE
-class QSortFilterProxyModel;
-#else
-#include <QSortFilterProxyModel>
-class FilterProxyModel : public QSortFilterProxyModel
-{
-    Q_OBJECT
-public:
-    explicit FilterProxyModel(QObject* parent = nullptr);
-    virtual ~FilterProxyModel();
-
-    void setfilerString(const QString &str) {
-        filterStr_ = str;
-        invalidateFilter();
-    }
-
-protected:
-    bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const;
-
-private:
-    QString filterStr_;
-};
-#endif
 //==============================
 class ActionView : public QListView
 {
@@ -64,8 +43,8 @@ class ActionView : public QListView
 public:
     enum Role
     {
-        ActionRole = Qt::UserRole
-            , FilterRole = ActionRole + 1
+        DesktopFileRole = Qt::UserRole
+            , IconNameRole = DesktopFileRole + 1
     };
 
 public:
@@ -74,18 +53,15 @@ public:
     /*! \brief Remove all items from model
      */
     void clear();
-    /*! \brief Add action proxy to the underlying model
-     */
-    void addAction(QAction * action);
-    /*! \brief Check if action already exists in the view/model.
-     *
-     * \note The equality is evaluated just on text() & toolTip()
+    /*! \brief Set the index used for the lookup of entries matching the filter
      */
-    bool existsAction(QAction const * action) const;
-    /*! \brief Fill the view with all actions from \param menu
+    void setSearchIndex(MenuSearchIndex const * index);
+    /*! \brief Set the loader of the items' icons
      */
-    void fillActions(QMenu * menu);
+    void setIconLoader(MenuIconLoader * loader);
     /*! \brief Sets the filter for entries to be presented
+     *
+     * Only the best (ranked) matches are presented, the best one is selected.
      */
     void setFilter(QString const & filter);
     /*! \brief Set the maximum number of items/results to show
@@ -96,7 +72,7 @@ public:
     void setMaxItemWidth(int max);
 
 public slots:
-    /*! \brief Trigger action on currently active item
+    /*! \brief Launch the application of the currently active item
      */
     void activateCurrent();
 
@@ -111,19 +87,13 @@ signals:
 
 private slots:
     void onActivated(QModelIndex const & index);
-    void onActionDestroyed();
-
-private:
-    void fillActionsRecursive(QMenu * menu);
+    void onIconLoaded(QString const & name, QIcon const & icon);
+    void onIconsReset();
 
 private:
     QStandardItemModel * mModel;
     QPoint mDragStartPosition;
-#ifdef HAVE_MENU_CACHE
-    QSortFilterProxyModel * mProxy;
-#else
-    FilterProxyModel * mProxy;
-#endif
+    MenuSearchIndex const * mSearchIndex;
     int mMaxItemsToShow;
 };
 
@@ -0,0 +1,114 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "launchhistory.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+
+namespace
+{
+    // the applications not launched during the last ~year are forgotten
+    constexpr qint64 MAX_AGE = 365 * 24 * 3600;
+}
+
+LaunchHistory::LaunchHistory()
+    : mFileName{QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+        + QStringLiteral("/lxqt/panel/mainmenu-launches")}
+{
+    load();
+}
+
+void LaunchHistory::recordLaunch(QString const & id)
+{
+    if (id.isEmpty())
+        return;
+
+    Launches & launches = mLaunches[id];
+    ++launches.count;
+    launches.last = QDateTime::currentSecsSinceEpoch();
+    save();
+}
+
+qreal LaunchHistory::frecency(QString const & id) const
+{
+    const auto launches = mLaunches.constFind(id);
+    if (launches == mLaunches.cend())
+        return 0;
+
+    const qint64 age = QDateTime::currentSecsSinceEpoch() - launches->last;
+    qreal weight;
+    if (age < 4 * 24 * 3600)
+        weight = 1.0;
+    else if (age < 14 * 24 * 3600)
+        weight = 0.7;
+    else if (age < 31 * 24 * 3600)
+        weight = 0.5;
+    else if (age < 90 * 24 * 3600)
+        weight = 0.3;
+    else
+        weight = 0.1;
+    return launches->count * weight;
+}
+
+void LaunchHistory::load()
+{
+    QFile file{mFileName};
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    QTextStream in{&file};
+    QString line;
+    while (in.readLineInto(&line))
+    {
+        // <count>\t<last launch>\t<desktop file>
+        const QStringList fields = line.split(QLatin1Char('\t'));
+        if (fields.size() != 3)
+            continue;
+        const Launches launches{fields.at(0).toInt(), fields.at(1).toLongLong()};
+        if (0 < launches.count && now - launches.last < MAX_AGE)
+            mLaunches.insert(fields.at(2), launches);
+    }
+}
+
+void LaunchHistory::save() const
+{
+    QDir{}.mkpath(QFileInfo{mFileName}.absolutePath());
+    QSaveFile file{mFileName};
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return;
+
+    QTextStream out{&file};
+    for (auto i = mLaunches.cbegin(), i_e = mLaunches.cend(); i != i_e; ++i)
+        out << i->count << '\t' << i->last << '\t' << i.key() << '\n';
+    out.flush();
+    file.commit();
+}
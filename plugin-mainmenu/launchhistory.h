@@ -0,0 +1,67 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#if !defined(LAUNCH_HISTORY_H)
+#define LAUNCH_HISTORY_H
+
+#include <QHash>
+#include <QString>
+
+/*! \brief Launch counts and times of the menu applications
+ *
+ * The history is kept in a small file in the user's data directory and
+ * provides the "frecency" (frequency weighted by recency) of the
+ * applications for ranking the search results.
+ */
+class LaunchHistory
+{
+public:
+    LaunchHistory();
+
+    /*! \brief Note a launch of the application with desktop file \param id
+     * (and store the history)
+     */
+    void recordLaunch(QString const & id);
+    /*! \brief Frecency of the application with desktop file \param id,
+     * 0 for never launched ones
+     */
+    qreal frecency(QString const & id) const;
+
+private:
+    void load();
+    void save() const;
+
+private:
+    struct Launches
+    {
+        int count;
+        qint64 last; //!< seconds since epoch
+    };
+
+    QString mFileName;
+    QHash<QString, Launches> mLaunches;
+};
+
+#endif //LAUNCH_HISTORY_H
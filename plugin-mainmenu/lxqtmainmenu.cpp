@@ -42,22 +42,32 @@
 #include <algorithm> // for find_if()
 #include <QApplication>
 #include <QMetaEnum>
+#include <QDebug>
 #include <QStringBuilder>
 
-#include <XdgMenuWidget>
 #include <XdgIcon>
 
 #ifdef HAVE_MENU_CACHE
     #include "xdgcachedmenu.h"
 #else
+    #include "xdgsnapshotmenu.h"
     #include <QStandardPaths>
     #include <QClipboard>
     #include <QMimeData>
-    #include <XdgAction>
+    #include <QFutureWatcher>
+    #include <QtConcurrent>
+    #include <XdgDesktopFile>
 #endif
 
 #define DEFAULT_SHORTCUT "Alt+F1"
 
+#ifndef HAVE_MENU_CACHE
+static QStringList menuEnvironments()
+{
+    return QStringList() << QStringLiteral("X-LXQT") << QStringLiteral("LXQt");
+}
+#endif
+
 LXQtMainMenu::LXQtMainMenu(const ILXQtPanelPluginStartupInfo &startupInfo):
     QObject(),
     ILXQtPanelPlugin(startupInfo),
@@ -70,11 +80,23 @@ LXQtMainMenu::LXQtMainMenu(const ILXQtPanelPluginStartupInfo &startupInfo):
     mFilterShow(true),
     mFilterClear(false),
     mFilterShowHideMenu(true),
-    mHeavyMenuChanges(false)
+    mHeavyMenuChanges(false),
+    mWarmUp(false),
+    mWarmedUp(false),
+    mShownOnce(false)
 {
 #ifdef HAVE_MENU_CACHE
     mMenuCache = nullptr;
     mMenuCacheNotify = nullptr;
+#else
+    mReadingMenu = false;
+    mReadMenuAgain = false;
+    // wait for all the changes of an (un)installation
+    mReadMenuTimer.setSingleShot(true);
+    mReadMenuTimer.setInterval(1000);
+    connect(&mReadMenuTimer, &QTimer::timeout, this, &LXQtMainMenu::readMenu);
+    connect(&mMenuWatcher, &QFileSystemWatcher::directoryChanged, &mReadMenuTimer, QOverload<>::of(&QTimer::start));
+    connect(&mMenuWatcher, &QFileSystemWatcher::fileChanged, &mReadMenuTimer, QOverload<>::of(&QTimer::start));
 #endif
 
     mDelayedPopup.setSingleShot(true);
@@ -82,10 +104,10 @@ LXQtMainMenu::LXQtMainMenu(const ILXQtPanelPluginStartupInfo &startupInfo):
     connect(&mDelayedPopup, &QTimer::timeout, this, &LXQtMainMenu::showHideMenu);
     mHideTimer.setSingleShot(true);
     mHideTimer.setInterval(250);
-
-    mSearchTimer.setSingleShot(true);
-    connect(&mSearchTimer, &QTimer::timeout, this, &LXQtMainMenu::searchMenu);
-    mSearchTimer.setInterval(350); // typing speed (not very fast)
+    // let the startup (of the panel and the session) finish first
+    mWarmUpTimer.setSingleShot(true);
+    mWarmUpTimer.setInterval(3000);
+    connect(&mWarmUpTimer, &QTimer::timeout, this, &LXQtMainMenu::warmUpMenu);
 
     mButton.setAutoRaise(true);
     mButton.setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Minimum);
@@ -104,6 +126,12 @@ LXQtMainMenu::LXQtMainMenu(const ILXQtPanelPluginStartupInfo &startupInfo):
     mSearchView = new ActionView;
     mSearchView->setVisible(false);
     mSearchView->setContextMenuPolicy(Qt::CustomContextMenu);
+    mSearchView->setSearchIndex(&mSearchIndex);
+    mSearchView->setIconLoader(&mIconLoader);
+    mSearchIndex.setLaunchHistory(&mLaunchHistory);
+    connect(mSearchView, &QAbstractItemView::activated, this, [this] (QModelIndex const & index) {
+        mLaunchHistory.recordLaunch(index.data(ActionView::DesktopFileRole).toString());
+    });
     connect(mSearchView, &QAbstractItemView::activated, this, &LXQtMainMenu::showHideMenu);
     connect(mSearchView, &ActionView::requestShowHideMenu, this, &LXQtMainMenu::showHideMenu);
     connect(mSearchView, &QWidget::customContextMenuRequested, this, &LXQtMainMenu::onRequestingCustomMenu);
@@ -111,9 +139,9 @@ LXQtMainMenu::LXQtMainMenu(const ILXQtPanelPluginStartupInfo &startupInfo):
     mSearchEdit = new QLineEdit;
     mSearchEdit->setClearButtonEnabled(true);
     mSearchEdit->setPlaceholderText(LXQtMainMenu::tr("Search..."));
-    connect(mSearchEdit, &QLineEdit::textChanged, this, [this] (QString const &) {
-        mSearchTimer.start();
-    });
+    // Note: the lookup goes through the prebuilt mSearchIndex, so there is no need
+    // to debounce the typing
+    connect(mSearchEdit, &QLineEdit::textChanged, this, &LXQtMainMenu::searchMenu);
     connect(mSearchEdit, &QLineEdit::returnPressed, mSearchView, &ActionView::activateCurrent);
     mSearchEditAction->setDefaultWidget(mSearchEdit);
     QTimer::singleShot(0, this, [this] {
@@ -185,6 +213,7 @@ void LXQtMainMenu::showMenu()
     if (!mMenu)
         return;
 
+    mShowLatency.start();
     willShowWindow(mMenu);
     // Just using Qt`s activateWindow() won't work on some WMs like Kwin.
     // Solution is to execute menu 1ms later using timer
@@ -199,12 +228,129 @@ void LXQtMainMenu::showMenu()
     }
 }
 
+/************************************************
+
+ ************************************************/
+void LXQtMainMenu::warmUpMenu()
+{
+    if (!mMenu || mMenu->isVisible())
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+    // what the first showing would do, except mapping of the windows
+    const auto prepare = [] (QMenu * menu) {
+        menu->ensurePolished();
+        menu->adjustSize();
+        menu->winId(); // creates the native window
+    };
+    prepare(mMenu);
+    const auto actions = mMenu->actions();
+    for (auto const & action : actions)
+    {
+#ifdef HAVE_MENU_CACHE
+        if (XdgCachedMenu * submenu = qobject_cast<XdgCachedMenu *>(action->menu()))
+        {
+#else
+        if (XdgSnapshotMenu * submenu = qobject_cast<XdgSnapshotMenu *>(action->menu()))
+        {
+            submenu->ensureMaterialized();
+#endif
+            submenu->prefetchIcons();
+            prepare(submenu);
+        }
+    }
+    mWarmedUp = true;
+    qDebug() << "main menu: prepared in advance in" << timer.elapsed() << "ms";
+}
+
 #ifdef HAVE_MENU_CACHE
 // static
 void LXQtMainMenu::menuCacheReloadNotify(MenuCache* cache, gpointer user_data)
 {
     reinterpret_cast<LXQtMainMenu*>(user_data)->buildMenu();
 }
+#else
+/************************************************
+
+ ************************************************/
+void LXQtMainMenu::readMenu()
+{
+    if (mReadingMenu)
+    {
+        // the result of the running read is already outdated
+        mReadMenuAgain = true;
+        return;
+    }
+    mReadingMenu = true;
+
+    QFutureWatcher<QSharedPointer<const MenuSnapshot>> * future_watcher = new QFutureWatcher<QSharedPointer<const MenuSnapshot>>{this};
+    connect(future_watcher, &QFutureWatcher<QSharedPointer<const MenuSnapshot>>::finished, this, [this, future_watcher]
+        {
+            future_watcher->deleteLater();
+            mReadingMenu = false;
+            if (mReadMenuAgain)
+            {
+                mReadMenuAgain = false;
+                readMenu();
+                return;
+            }
+
+            const QSharedPointer<const MenuSnapshot> snapshot = future_watcher->result();
+            if (!snapshot->isValid())
+            {
+                QMessageBox::warning(nullptr, QStringLiteral("Parse error"), snapshot->errorString());
+                return;
+            }
+
+            const QStringList watched = mMenuWatcher.files() + mMenuWatcher.directories();
+            if (!watched.isEmpty())
+                mMenuWatcher.removePaths(watched);
+            mMenuWatcher.addPaths(snapshot->watchedPaths());
+
+            if (mSnapshot && mSnapshot->root() == snapshot->root())
+            {
+                // nothing changed (e.g. the cached snapshot was up to date)
+                mPendingSnapshot.reset();
+                return;
+            }
+
+            // don't pull the menu from under the user's hands
+            if (mMenu && mMenu->isVisible())
+                mPendingSnapshot = snapshot;
+            else
+                setSnapshot(snapshot);
+        });
+
+    const QString menu_file = mMenuFile;
+    const QString log_dir = mLogDir;
+    future_watcher->setFuture(QtConcurrent::run([menu_file, log_dir]
+        {
+            const QSharedPointer<const MenuSnapshot> snapshot = MenuSnapshot::read(menu_file, log_dir, menuEnvironments());
+            if (snapshot->isValid())
+                snapshot->save();
+            return snapshot;
+        }));
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtMainMenu::setSnapshot(QSharedPointer<const MenuSnapshot> const & snapshot)
+{
+    mPendingSnapshot.reset();
+    mSnapshot = snapshot;
+    if (!mMenu)
+    {
+        buildMenu();
+        return;
+    }
+
+    // apply just the differences, the menu and the index keep the rest
+    static_cast<XdgSnapshotMenu *>(mMenu)->update(mSnapshot->root());
+    mSearchIndex.update(mSnapshot->root());
+    searchMenu();
+}
 #endif
 
 /************************************************
@@ -248,20 +394,10 @@ void LXQtMainMenu::settingsChanged()
         }
         mMenuCacheNotify = menu_cache_add_reload_notify(mMenuCache, (MenuCacheReloadNotify)menuCacheReloadNotify, this);
 #else
-        mXdgMenu.setEnvironments(QStringList() << QStringLiteral("X-LXQT") << QStringLiteral("LXQt"));
-        mXdgMenu.setLogDir(mLogDir);
-
-        bool res = mXdgMenu.read(mMenuFile);
-        connect(&mXdgMenu, &XdgMenu::changed, this, &LXQtMainMenu::buildMenu);
-        if (res)
-        {
-            QTimer::singleShot(1000, this, &LXQtMainMenu::buildMenu);
-        }
-        else
-        {
-            QMessageBox::warning(nullptr, QStringLiteral("Parse error"), mXdgMenu.errorString());
-            return;
-        }
+        // show the cached menu at once, the read fixes it if anything changed
+        if (const QSharedPointer<const MenuSnapshot> cached = MenuSnapshot::load(mMenuFile, menuEnvironments()))
+            setSnapshot(cached);
+        readMenu();
 #endif
     }
 
@@ -273,6 +409,9 @@ void LXQtMainMenu::settingsChanged()
     mFilterShow = settings()->value(QStringLiteral("filterShow"), true).toBool();
     mFilterClear = settings()->value(QStringLiteral("filterClear"), false).toBool();
     mFilterShowHideMenu = settings()->value(QStringLiteral("filterShowHideMenu"), true).toBool();
+    mWarmUp = settings()->value(QStringLiteral("warmUp"), false).toBool();
+    if (mWarmUp && !mWarmedUp)
+        mWarmUpTimer.start();
     if (mMenu)
     {
         mSearchEdit->setVisible(mFilterMenu || mFilterShow);
@@ -286,7 +425,20 @@ void LXQtMainMenu::settingsChanged()
     realign();
 }
 
-static bool filterMenu(QMenu * menu, QString const & filter)
+#ifndef HAVE_MENU_CACHE
+static bool containsMatch(MenuSnapshot::Item const & menu, QSet<QString> const & matches)
+{
+    for (auto const & item : menu.children)
+    {
+        if ((MenuSnapshot::Item::Application == item.type && matches.contains(item.desktopFile))
+                || (MenuSnapshot::Item::Menu == item.type && containsMatch(item, matches)/*recursion*/))
+            return true;
+    }
+    return false;
+}
+#endif
+
+static bool filterMenu(QMenu * menu, QString const & filter, QSet<QString> const & matches)
 {
     bool has_visible = false;
     const auto actions = menu->actions();
@@ -294,7 +446,14 @@ static bool filterMenu(QMenu * menu, QString const & filter)
     {
         if (QMenu * sub_menu = action->menu())
         {
-            action->setVisible(filterMenu(sub_menu, filter)/*recursion*/);
+#ifndef HAVE_MENU_CACHE
+            //not yet filled submenu -> the decision from the snapshot
+            XdgSnapshotMenu * snapshot_menu = qobject_cast<XdgSnapshotMenu *>(sub_menu);
+            if (nullptr != snapshot_menu && !snapshot_menu->isMaterialized())
+                action->setVisible(filter.isEmpty() || containsMatch(snapshot_menu->item(), matches));
+            else
+#endif
+                action->setVisible(filterMenu(sub_menu, filter, matches)/*recursion*/);
             has_visible |= action->isVisible();
         } else if (nullptr != qobject_cast<QWidgetAction *>(action))
         {
@@ -303,23 +462,7 @@ static bool filterMenu(QMenu * menu, QString const & filter)
         } else if (!action->isSeparator())
         {
             //real menu action -> app
-            bool visible(filter.isEmpty() || action->text().contains(filter, Qt::CaseInsensitive) || action->toolTip().contains(filter, Qt::CaseInsensitive));
-#ifndef HAVE_MENU_CACHE
-            if(!visible)
-            {
-                if (XdgAction * xdgAction = qobject_cast<XdgAction *>(action))
-                {
-                    const XdgDesktopFile& df = xdgAction->desktopFile();
-                    QStringList list = df.expandExecString();
-                    if (!list.isEmpty())
-                    {
-                        if (list.at(0).contains(filter, Qt::CaseInsensitive))
-                            visible = true;
-                    }
-                }
-            }
-#endif
-            action->setVisible(visible);
+            action->setVisible(filter.isEmpty() || matches.contains(MenuSearchIndex::actionId(action)));
             has_visible |= action->isVisible();
         }
     }
@@ -374,7 +517,7 @@ void LXQtMainMenu::searchMenu()
         mHeavyMenuChanges = false;
     }
     if (mFilterMenu && !(mFilterShow && mFilterShowHideMenu))
-        filterMenu(mMenu, text);
+        filterMenu(mMenu, text, text.isEmpty() ? QSet<QString>{} : mSearchIndex.match(text));
 
 }
 
@@ -414,10 +557,17 @@ void LXQtMainMenu::buildMenu()
         delete mMenu;
     }
 #ifdef HAVE_MENU_CACHE
-    mMenu = new XdgCachedMenu(mMenuCache, &mButton);
+    mMenu = new XdgCachedMenu(mMenuCache, &mIconLoader, &mButton);
 #else
-    mMenu = new XdgMenuWidget(mXdgMenu, QLatin1String(""), &mButton);
-    addContextMenu(mMenu);
+    XdgSnapshotMenu * menu = new XdgSnapshotMenu(mSnapshot->root(), &mIconLoader, &mButton);
+    mMenu = menu;
+    // all the submenus (incl. the first level ones) are set up upon their creation
+    connect(menu, &XdgSnapshotMenu::menuCreated, this, &LXQtMainMenu::setupSubmenu);
+    menu->ensureMaterialized();
+    connect(mMenu, &QMenu::aboutToHide, this, [this] {
+        if (mPendingSnapshot && !mMenu->isVisible())
+            setSnapshot(mPendingSnapshot);
+    }, Qt::QueuedConnection);
 #endif
     mMenu->setObjectName(QStringLiteral("TopLevelMainMenu"));
     setTranslucentMenus(mMenu);
@@ -432,6 +582,10 @@ void LXQtMainMenu::buildMenu()
     menuInstallEventFilter(mMenu, this);
     connect(mMenu, &QMenu::aboutToHide, &mHideTimer, QOverload<>::of(&QTimer::start));
     connect(mMenu, &QMenu::aboutToShow, &mHideTimer, &QTimer::stop);
+    // Note: the triggered() is emitted also for the actions of the submenus
+    connect(mMenu, &QMenu::triggered, this, [this] (QAction * action) {
+        mLaunchHistory.recordLaunch(MenuSearchIndex::actionId(action));
+    });
 
     mMenu->addSeparator();
     mMenu->addAction(mSearchViewAction);
@@ -448,28 +602,47 @@ void LXQtMainMenu::buildMenu()
     });
     mSearchEdit->setVisible(mFilterMenu || mFilterShow);
     mSearchEditAction->setVisible(mFilterMenu || mFilterShow);
-    mSearchView->fillActions(mMenu);
+    mSearchIndex.clear();
+#ifdef HAVE_MENU_CACHE
+    mSearchIndex.build(mMenu);
+#else
+    mSearchIndex.update(mSnapshot->root());
+#endif
 
     searchMenu();
     setMenuFontSize();
+    mWarmedUp = false;
+    mShownOnce = false;
+    if (mWarmUp)
+        mWarmUpTimer.start();
+    // have the icons of the top level ready for the first showing
+#ifdef HAVE_MENU_CACHE
+    static_cast<XdgCachedMenu *>(mMenu)->prefetchIcons();
+#else
+    menu->prefetchIcons();
+#endif
 }
 
+#ifndef HAVE_MENU_CACHE
 /************************************************
 
  ************************************************/
-void LXQtMainMenu::addContextMenu(QMenu *menu)
+void LXQtMainMenu::setupSubmenu(QMenu * menu)
 {
-    const auto actions = menu->actions();
-    for (auto const & action : actions)
-    {
-        if (action->menu())
-        {
-            action->menu()->setContextMenuPolicy(Qt::CustomContextMenu);
-            connect(action->menu(), &QWidget::customContextMenuRequested, this, &LXQtMainMenu::onRequestingCustomMenu);
-            addContextMenu(action->menu());
-        }
-    }
+    // the same as buildMenu() does for the submenus existing upon building
+    menu->setAttribute(Qt::WA_TranslucentBackground);
+    menu->installEventFilter(this);
+    menu->setContextMenuPolicy(Qt::CustomContextMenu);
+    connect(menu, &QWidget::customContextMenuRequested, this, &LXQtMainMenu::onRequestingCustomMenu);
+    menu->setFont(mMenu->font());
+    // the entries are created upon the first showing -> filter them also
+    connect(menu, &QMenu::aboutToShow, this, [this, menu] {
+        const QString text = mSearchEdit->text();
+        if (!text.isEmpty() && mFilterMenu && !(mFilterShow && mFilterShowHideMenu))
+            filterMenu(menu, text, mSearchIndex.match(text));
+    });
 }
+#endif
 
 void LXQtMainMenu::onRequestingCustomMenu(const QPoint& p)
 {
@@ -479,27 +652,24 @@ void LXQtMainMenu::onRequestingCustomMenu(const QPoint& p)
 #else
     QMenu *parentMenu = qobject_cast<QMenu*>(QObject::sender());
     ActionView *parentView = qobject_cast<ActionView*>(QObject::sender());
-    QAction *action;
+    QString desktopFile;
     QPoint globalPos;
     if (parentView != nullptr) {
-        action = parentView->indexAt(p).data(ActionView::ActionRole).value<QAction*>();
-        if (action == nullptr)
-            return;
+        desktopFile = parentView->indexAt(p).data(ActionView::DesktopFileRole).toString();
         globalPos = parentView->mapToGlobal(p);
     }
     else if (parentMenu != nullptr) {
-        action = parentMenu->actionAt(p);
+        QAction *action = parentMenu->actionAt(p);
         if (action == nullptr || action->menu() != nullptr || action->isSeparator())
             return;
+        desktopFile = MenuSearchIndex::actionId(action);
         globalPos = parentMenu->mapToGlobal(p);
     }
-    else {
+    if (desktopFile.isEmpty())
         return;
-    }
-    XdgAction *xdgAction = qobject_cast<XdgAction *>(action);
-    if (xdgAction == nullptr)
+    XdgDesktopFile df;
+    if (!df.load(desktopFile))
         return;
-    const XdgDesktopFile& df = xdgAction->desktopFile();
     QString file = df.fileName();
 
     QMenu menu;
@@ -592,6 +762,7 @@ void LXQtMainMenu::setMenuFontSize()
     // to an actual pixel size if necessary)
     icon_size = mTopMenuStyle.pixelMetric(QStyle::PM_SmallIconSize);
     mSearchView->setIconSize(QSize{icon_size, icon_size});
+    mIconLoader.setIconSize(icon_size);
 }
 
 
@@ -691,7 +862,13 @@ bool LXQtMainMenu::eventFilter(QObject *obj, QEvent *event)
 
         if (obj == mMenu)
         {
-            if (event->type() == QEvent::Resize)
+            if (event->type() == QEvent::Paint && mShowLatency.isValid())
+            {
+                qDebug() << "main menu:" << (mShownOnce ? "subsequent" : "first") << "opening took"
+                    << mShowLatency.elapsed() << "ms" << (mWarmedUp ? "(prepared in advance)" : "");
+                mShowLatency.invalidate();
+                mShownOnce = true;
+            } else if (event->type() == QEvent::Resize)
             {
                 QResizeEvent * e = dynamic_cast<QResizeEvent *>(event);
                 if (e->oldSize().isValid() && e->oldSize() != e->size())
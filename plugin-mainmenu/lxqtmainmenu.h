@@ -34,6 +34,9 @@
 
 #ifdef HAVE_MENU_CACHE
 #include <menu-cache/menu-cache.h>
+#else
+#include "menusnapshot.h"
+#include <QFileSystemWatcher>
 #endif
 
 #include <QLabel>
@@ -41,9 +44,13 @@
 #include <QDomElement>
 #include <QAction>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QKeySequence>
 
 #include "menustyle.h"
+#include "menusearchindex.h"
+#include "launchhistory.h"
+#include "menuiconloader.h"
 
 
 class QMenu;
@@ -83,7 +90,6 @@ protected:
 private:
     void setMenuFontSize();
     void setButtonIcon();
-    void addContextMenu(QMenu *menu);
 
 private:
     QToolButton mButton;
@@ -95,24 +101,40 @@ private:
     QLineEdit * mSearchEdit;
     QWidgetAction * mSearchViewAction;
     ActionView * mSearchView;
+    MenuSearchIndex mSearchIndex;
+    LaunchHistory mLaunchHistory;
+    MenuIconLoader mIconLoader;
     QAction * mMakeDirtyAction;
     bool mFilterMenu; //!< searching should perform hiding nonmatching items in menu
     bool mFilterShow; //!< searching should list matching items in top menu
     bool mFilterClear; //!< search field should be cleared upon showing the menu
     bool mFilterShowHideMenu; //!< while searching all (original) menu entries should be hidden
     bool mHeavyMenuChanges; //!< flag for filtering some mMenu events while heavy changes are performed
+    bool mWarmUp; //!< the menu windows should be prepared in advance
+    bool mWarmedUp; //!< the current menu was prepared in advance
+    bool mShownOnce; //!< the current menu was shown already
+    QElapsedTimer mShowLatency; //!< measuring of the time from the request to the painting
 
 #ifdef HAVE_MENU_CACHE
     MenuCache* mMenuCache;
     MenuCacheNotifyId mMenuCacheNotify;
     static void menuCacheReloadNotify(MenuCache* cache, gpointer user_data);
 #else
-    XdgMenu mXdgMenu;
+    QSharedPointer<const MenuSnapshot> mSnapshot;
+    QSharedPointer<const MenuSnapshot> mPendingSnapshot; //!< snapshot read while the menu was shown
+    QFileSystemWatcher mMenuWatcher;
+    QTimer mReadMenuTimer;
+    bool mReadingMenu;
+    bool mReadMenuAgain;
+
+    void readMenu();
+    void setSnapshot(QSharedPointer<const MenuSnapshot> const & snapshot);
+    void setupSubmenu(QMenu * menu);
 #endif
 
     QTimer mDelayedPopup;
     QTimer mHideTimer;
-    QTimer mSearchTimer;
+    QTimer mWarmUpTimer;
     QString mShortcutSeq;
     QString mMenuFile;
 
@@ -123,6 +145,7 @@ protected slots:
 
 private slots:
     void showMenu();
+    void warmUpMenu();
     void showHideMenu();
     void searchMenu();
     void setSearchFocus(QAction *action);
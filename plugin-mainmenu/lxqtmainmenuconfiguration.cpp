@@ -77,6 +77,10 @@ LXQtMainMenuConfiguration::LXQtMainMenuConfiguration(PluginSettings *settings, G
 
     connect(ui->customFontCB, &QAbstractButton::toggled, this, &LXQtMainMenuConfiguration::customFontChanged);
     connect(ui->customFontSizeSB, static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged), this, &LXQtMainMenuConfiguration::customFontSizeChanged);
+    connect(ui->warmUpCB, &QCheckBox::toggled, this, [this] (bool value) {
+        if (!mLockSettingChanges)
+            this->settings().setValue(QStringLiteral("warmUp"), value);
+    });
 
     connect(mShortcut, &GlobalKeyShortcut::Action::shortcutChanged, this, &LXQtMainMenuConfiguration::globalShortcutChanged);
 
@@ -137,6 +141,7 @@ void LXQtMainMenuConfiguration::loadSettings()
     systemFont.fromString(lxqtSettings.value(QStringLiteral("font"), this->font()).toString());
     lxqtSettings.endGroup();
     ui->customFontSizeSB->setValue(settings().value(QStringLiteral("customFontSize"), systemFont.pointSize()).toInt());
+    ui->warmUpCB->setChecked(settings().value(QStringLiteral("warmUp"), false).toBool());
     const bool filter_menu = settings().value(QStringLiteral("filterMenu"), true).toBool();
     ui->filterMenuCB->setChecked(filter_menu);
     const bool filter_show = settings().value(QStringLiteral("filterShow"), true).toBool();
@@ -0,0 +1,191 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+#include "menuiconloader.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QPixmap>
+#include <QThread>
+#include <QtConcurrent>
+
+namespace
+{
+    // the time (in msecs) spent by rasterizing the theme icons per event loop iteration
+    const int THEME_ICONS_SLICE = 4;
+
+    QImage loadImage(QString const & file, int size)
+    {
+        QImageReader reader{file};
+        QSize scaled = reader.size();
+        if (scaled.isValid())
+            scaled.scale(size, size, Qt::KeepAspectRatio);
+        else
+            scaled = QSize{size, size};
+        // Note: the reader scales (smoothly) also if the format can't do that itself
+        reader.setScaledSize(scaled);
+        const QImage image = reader.read();
+        return image.isNull() ? image : image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    }
+}
+
+MenuIconLoader::MenuIconLoader(QObject * parent /*= nullptr*/)
+    : QObject{parent}
+    , mIconSize{16}
+    , mGeneration{0}
+{
+    // the rasterization shouldn't compete with the whole desktop
+    mPool.setMaxThreadCount(qBound(1, QThread::idealThreadCount() / 2, 4));
+
+    mThemeIconsTimer.setSingleShot(true);
+    mThemeIconsTimer.setInterval(0);
+    connect(&mThemeIconsTimer, &QTimer::timeout, this, &MenuIconLoader::loadThemeIcons);
+}
+
+MenuIconLoader::~MenuIconLoader()
+{
+    mPool.clear();
+    mPool.waitForDone();
+}
+
+void MenuIconLoader::setIconSize(int size)
+{
+    if (mIconSize == size)
+        return;
+    mIconSize = size;
+    reset();
+}
+
+QIcon MenuIconLoader::icon(QString const & name)
+{
+    checkTheme();
+    const auto icon = mIcons.constFind(name);
+    if (icon != mIcons.cend())
+        return *icon;
+    load(name);
+    return QIcon{};
+}
+
+void MenuIconLoader::prefetch(QStringList const & names)
+{
+    checkTheme();
+    for (auto const & name : names)
+    {
+        if (!mIcons.contains(name))
+            load(name);
+    }
+}
+
+void MenuIconLoader::checkTheme()
+{
+    if (QIcon::themeName() == mThemeName)
+        return;
+    mThemeName = QIcon::themeName();
+    reset();
+}
+
+void MenuIconLoader::reset()
+{
+    mIcons.clear();
+    mLoading.clear();
+    mThemeIcons.clear();
+    ++mGeneration;
+    emit iconsReset();
+}
+
+void MenuIconLoader::load(QString const & name)
+{
+    if (mLoading.contains(name))
+        return;
+    mLoading.insert(name);
+
+    // the themed icons are looked up by Qt, the same as everywhere else in the panel
+    if (!name.startsWith(QLatin1Char('/')))
+    {
+        mThemeIcons.append(name);
+        if (!mThemeIconsTimer.isActive())
+            mThemeIconsTimer.start();
+        return;
+    }
+
+    // the file is known, just the rasterization is done in the worker
+    const quint32 generation = mGeneration;
+    const qreal ratio = qApp->devicePixelRatio();
+    QFutureWatcher<QImage> * watcher = new QFutureWatcher<QImage>{this};
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, name, generation, ratio]
+        {
+            watcher->deleteLater();
+            if (generation != mGeneration)
+                return;
+
+            QImage image = watcher->result();
+            QIcon icon;
+            if (!image.isNull())
+            {
+                image.setDevicePixelRatio(ratio);
+                icon = QIcon{QPixmap::fromImage(image)};
+            } else
+            {
+                icon = QIcon::fromTheme(QStringLiteral("unknown"));
+            }
+            loaded(name, icon);
+        });
+
+    const int size = qRound(mIconSize * ratio);
+    watcher->setFuture(QtConcurrent::run(&mPool, [name, size]
+        {
+            return loadImage(name, size);
+        }));
+}
+
+void MenuIconLoader::loadThemeIcons()
+{
+    // the icons are rasterized in slices, so the panel stays responsive
+    QElapsedTimer slice;
+    slice.start();
+    while (!mThemeIcons.isEmpty() && THEME_ICONS_SLICE > slice.elapsed())
+    {
+        const QString name = mThemeIcons.takeFirst();
+        // Note: We don't use the QIcon::fromTheme(const QString &name
+        // , const QIcon &fallback) overload because of "availableSizes()"
+        // check in it, see https://bugreports.qt.io/browse/QTBUG-63187
+        QIcon icon = QIcon::fromTheme(name);
+        if (icon.isNull())
+            icon = QIcon::fromTheme(QStringLiteral("unknown"));
+        // rasterized now and not upon showing the menu
+        const QPixmap pixmap = icon.pixmap(mIconSize);
+        loaded(name, pixmap.isNull() ? icon : QIcon{pixmap});
+    }
+    if (!mThemeIcons.isEmpty())
+        mThemeIconsTimer.start();
+}
+
+void MenuIconLoader::loaded(QString const & name, QIcon const & icon)
+{
+    mLoading.remove(name);
+    mIcons.insert(name, icon);
+    emit iconLoaded(name, icon);
+}
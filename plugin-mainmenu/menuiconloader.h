@@ -0,0 +1,93 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#if !defined(MENU_ICON_LOADER_H)
+#define MENU_ICON_LOADER_H
+
+#include <QObject>
+#include <QHash>
+#include <QIcon>
+#include <QSet>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+
+/*! \brief Loader of the menu icons ahead of showing the menus
+ *
+ * The theme icons are looked up by QIcon::fromTheme() (so the menu shows the
+ * same icons as the rest of the panel) and rasterized to the menu's icon size
+ * in short slices of the event loop iterations. The icons given by their file
+ * path are read and rasterized into QImages in a thread pool. Either way no
+ * SVG is rendered while a menu is being shown.
+ */
+class MenuIconLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MenuIconLoader(QObject * parent = nullptr);
+    ~MenuIconLoader();
+
+    /*! \brief Set the size (in device independent pixels) of the loaded icons
+     *
+     * \note The already loaded icons are forgotten upon the size change
+     * and the iconsReset() is emitted.
+     */
+    void setIconSize(int size);
+    /*! \brief Return the icon \param name if it is loaded already
+     *
+     * If not, the loading is started and the null icon is returned; the
+     * iconLoaded() is emitted when the icon is available.
+     */
+    QIcon icon(QString const & name);
+    /*! \brief Start loading of the icons \param names (which are not loaded yet)
+     */
+    void prefetch(QStringList const & names);
+
+signals:
+    void iconLoaded(QString const & name, QIcon const & icon);
+    /*! \brief The icons given out so far are outdated (by the icon size or
+     * theme change), the users should drop them and ask for them again
+     */
+    void iconsReset();
+
+private:
+    void checkTheme();
+    void reset();
+    void load(QString const & name);
+    void loadThemeIcons();
+    void loaded(QString const & name, QIcon const & icon);
+
+private:
+    QThreadPool mPool;
+    QHash<QString, QIcon> mIcons;
+    QSet<QString> mLoading;
+    QStringList mThemeIcons; //!< the theme icons to be loaded, in the order of the requests
+    QTimer mThemeIconsTimer;
+    QString mThemeName;
+    int mIconSize;
+    quint32 mGeneration; //!< for dropping the results of loads with outdated size/theme
+};
+
+#endif //MENU_ICON_LOADER_H
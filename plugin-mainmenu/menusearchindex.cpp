@@ -0,0 +1,376 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "menusearchindex.h"
+#include "launchhistory.h"
+#ifdef HAVE_MENU_CACHE
+    #include "xdgcachedmenu.h"
+#else
+    #include "xdgsnapshotmenu.h"
+#endif
+
+#include <QAction>
+#include <QMenu>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace
+{
+    inline quint64 trigram(QString const & str, int pos)
+    {
+        return (quint64{str.at(pos).unicode()} << 32)
+            | (quint64{str.at(pos + 1).unicode()} << 16)
+            | quint64{str.at(pos + 2).unicode()};
+    }
+#ifndef HAVE_MENU_CACHE
+
+    void collectApplications(MenuSnapshot::Item const & menu, QVector<MenuSnapshot::Item const *> & applications)
+    {
+        for (auto const & item : menu.children)
+        {
+            if (MenuSnapshot::Item::Menu == item.type)
+                collectApplications(item, applications); //recursion
+            else if (MenuSnapshot::Item::Application == item.type)
+                applications.append(&item);
+        }
+    }
+
+    QStringList indexedFields(MenuSnapshot::Item const & item)
+    {
+        return QStringList{} << item.title
+            << item.genericName
+            << item.keywords.join(QLatin1Char(' '))
+            << item.comment
+            << item.exec;
+    }
+#endif
+}
+
+void MenuSearchIndex::clear()
+{
+    mEntries.clear();
+    mTrigrams.clear();
+    mIds.clear();
+    mRemoved = 0;
+}
+
+#ifdef HAVE_MENU_CACHE
+void MenuSearchIndex::build(QMenu * menu)
+{
+    const auto actions = menu->actions();
+    for (auto const & action : actions)
+    {
+        if (QMenu * sub_menu = action->menu())
+        {
+            build(sub_menu); //recursion
+        } else if (XdgCachedMenuAction * cached_action = qobject_cast<XdgCachedMenuAction *>(action))
+        {
+            //real menu action -> app
+            QString title = action->text();
+            title.replace(QLatin1String("&&"), QLatin1String("&"));
+            Entry entry{cached_action->filePath(), title, action->toolTip(), cached_action->iconName()
+                , normalize(title), QString{}, false, false, 0};
+            // the same fields as the indexedFields() of a MenuSnapshot::Item
+            addEntry(std::move(entry), QStringList{} << title
+                    << cached_action->genericName()
+                    << cached_action->keywords().join(QLatin1Char(' '))
+                    << action->toolTip()
+                    << cached_action->exec());
+        }
+    }
+}
+#else
+void MenuSearchIndex::update(MenuSnapshot::Item const & menu)
+{
+    QVector<MenuSnapshot::Item const *> applications;
+    collectApplications(menu, applications);
+
+    // the present entries by the data they were made of
+    QHash<uint, QVector<int>> unmatched;
+    for (int i = 0, i_e = mEntries.size(); i < i_e; ++i)
+    {
+        if (!mEntries.at(i).removed)
+            unmatched[mEntries.at(i).source].append(i);
+    }
+
+    QVector<MenuSnapshot::Item const *> added;
+    QVector<uint> added_sources;
+    for (auto const * item : qAsConst(applications))
+    {
+        QStringList source = indexedFields(*item);
+        source << item->menuText() << item->icon << item->desktopFile;
+        const uint hash = qHashRange(source.cbegin(), source.cend());
+
+        bool found = false;
+        const auto candidates = unmatched.find(hash);
+        if (candidates != unmatched.end())
+        {
+            for (auto i = candidates->begin(); i != candidates->end(); ++i)
+            {
+                if (mEntries.at(*i).id == item->desktopFile)
+                {
+                    candidates->erase(i);
+                    found = true;
+                    break;
+                }
+            }
+        }
+        if (!found)
+        {
+            added.append(item);
+            added_sources.append(hash);
+        }
+    }
+
+    for (auto const & indexes : qAsConst(unmatched))
+    {
+        for (const int i : indexes)
+            removeEntry(i);
+    }
+    for (int i = 0, i_e = added.size(); i < i_e; ++i)
+    {
+        MenuSnapshot::Item const & item = *added.at(i);
+        Entry entry{item.desktopFile, item.menuText(), item.comment, item.icon
+            , normalize(item.title), QString{}, false, false, added_sources.at(i)};
+        addEntry(std::move(entry), indexedFields(item));
+    }
+
+    if (0 < mRemoved && mRemoved * 2 >= mEntries.size())
+        compact();
+}
+#endif
+
+void MenuSearchIndex::addEntry(Entry && entry, QStringList fields)
+{
+    fields.removeAll(QString{});
+    fields.removeDuplicates();
+
+    entry.text = normalize(fields.join(QLatin1Char('\n')));
+    insertEntry(std::move(entry));
+}
+
+void MenuSearchIndex::insertEntry(Entry && entry)
+{
+    const int index = mEntries.size();
+    QVector<int> & ids = mIds[entry.id];
+    entry.duplicate = !ids.isEmpty();
+    entry.removed = false;
+    ids.append(index);
+    for (int i = 0; i + 2 < entry.text.size(); ++i)
+    {
+        QVector<int> & postings = mTrigrams[trigram(entry.text, i)];
+        // entries are added in increasing order, the same trigram may repeat
+        if (postings.isEmpty() || postings.last() != index)
+            postings.append(index);
+    }
+    mEntries.append(std::move(entry));
+}
+
+void MenuSearchIndex::removeEntry(int index)
+{
+    Entry & entry = mEntries[index];
+    entry.removed = true;
+    ++mRemoved;
+
+    // the next entry with the same desktop file takes over
+    const auto ids = mIds.find(entry.id);
+    ids->removeOne(index);
+    if (ids->isEmpty())
+        mIds.erase(ids);
+    else if (!entry.duplicate)
+        mEntries[ids->first()].duplicate = false;
+}
+
+void MenuSearchIndex::compact()
+{
+    QVector<Entry> entries;
+    entries.swap(mEntries);
+    clear();
+    mEntries.reserve(entries.size());
+    // no need to normalize again
+    for (auto & entry : entries)
+    {
+        if (!entry.removed)
+            insertEntry(std::move(entry));
+    }
+}
+
+QSet<QString> MenuSearchIndex::match(QString const & filter) const
+{
+    QSet<QString> result;
+    const QString needle = normalize(filter);
+    if (needle.size() < 3)
+    {
+        // too short for the trigram table (and most of the entries match anyway)
+        for (auto const & entry : mEntries)
+        {
+            if (!entry.removed && entry.text.contains(needle))
+                result.insert(entry.id);
+        }
+        return result;
+    }
+
+    // every match contains all the trigrams of the needle -> verify just the
+    // entries of the least frequent one
+    QVector<int> const * candidates = nullptr;
+    for (int i = 0; i + 2 < needle.size(); ++i)
+    {
+        const auto postings = mTrigrams.constFind(trigram(needle, i));
+        if (postings == mTrigrams.cend())
+            return result;
+        if (nullptr == candidates || postings->size() < candidates->size())
+            candidates = &*postings;
+    }
+    for (const int i : *candidates)
+    {
+        Entry const & entry = mEntries.at(i);
+        if (!entry.removed && entry.text.contains(needle))
+            result.insert(entry.id);
+    }
+    return result;
+}
+
+QVector<int> MenuSearchIndex::rank(QString const & filter, int count) const
+{
+    QVector<int> result;
+    const QString needle = normalize(filter);
+    if (needle.isEmpty() || 0 >= count)
+        return result;
+
+    struct Ranked
+    {
+        int score;
+        int entry;
+    };
+    // higher score first, the menu order for equal scores
+    const auto better = [] (Ranked const & a, Ranked const & b) {
+        return a.score > b.score || (a.score == b.score && a.entry < b.entry);
+    };
+    // bounded heap of the best matches, the worst of them on the top
+    std::vector<Ranked> heap;
+    heap.reserve(count);
+    for (int i = 0, i_e = mEntries.size(); i < i_e; ++i)
+    {
+        Entry const & entry = mEntries.at(i);
+        if (entry.duplicate || entry.removed)
+            continue;
+        const Ranked ranked{score(needle, entry), i};
+        if (0 >= ranked.score)
+            continue;
+        if (static_cast<int>(heap.size()) < count)
+        {
+            heap.push_back(ranked);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(ranked, heap.front()))
+        {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = ranked;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+    std::sort_heap(heap.begin(), heap.end(), better);
+
+    result.reserve(static_cast<int>(heap.size()));
+    for (auto const & ranked : heap)
+        result.append(ranked.entry);
+    return result;
+}
+
+void MenuSearchIndex::setLaunchHistory(LaunchHistory const * history)
+{
+    mLaunchHistory = history;
+}
+
+QString MenuSearchIndex::actionId(QAction const * action)
+{
+#ifdef HAVE_MENU_CACHE
+    if (XdgCachedMenuAction const * cached_action = qobject_cast<XdgCachedMenuAction const *>(action))
+        return cached_action->filePath();
+#else
+    if (XdgSnapshotMenuAction const * snapshot_action = qobject_cast<XdgSnapshotMenuAction const *>(action))
+        return snapshot_action->filePath();
+#endif
+    return QString{};
+}
+
+int MenuSearchIndex::score(QString const & needle, Entry const & entry) const
+{
+    int score;
+    const int pos = entry.name.indexOf(needle);
+    if (0 == pos)
+        score = 300; // name prefix
+    else if (0 < pos && !entry.name.at(pos - 1).isLetterOrNumber())
+        score = 200; // word prefix in the name
+    else if (0 < pos)
+        score = 150;
+    else if (entry.text.contains(needle))
+        score = 100; // generic name, keywords, comment, executable
+    else
+    {
+        // fuzzy: all the characters in the name in the same order, rewarding
+        // the consecutive ones and the starts of words
+        score = 50;
+        int from = 0;
+        int last = -2;
+        for (const QChar c : needle)
+        {
+            const int found = entry.name.indexOf(c, from);
+            if (0 > found)
+                return 0;
+            if (last + 1 == found)
+                score += 5;
+            else if (0 == found || !entry.name.at(found - 1).isLetterOrNumber())
+                score += 3;
+            else
+                score -= qMin(5, found - last);
+            last = found;
+            from = found + 1;
+        }
+        score = qBound(1, score, 99);
+    }
+
+    if (nullptr != mLaunchHistory)
+    {
+        // at most as much as the difference of a fuzzy and a name prefix match
+        const qreal frecency = mLaunchHistory->frecency(entry.id);
+        if (0 < frecency)
+            score += qMin(200, qRound(40 * std::log2(1 + frecency)));
+    }
+    return score;
+}
+
+QString MenuSearchIndex::normalize(QString const & str)
+{
+    const QString decomposed = str.normalized(QString::NormalizationForm_KD);
+    QString folded;
+    folded.reserve(decomposed.size());
+    for (const QChar c : decomposed)
+    {
+        if (!c.isMark())
+            folded.append(c);
+    }
+    return folded.toCaseFolded();
+}
@@ -0,0 +1,132 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#if !defined(MENU_SEARCH_INDEX_H)
+#define MENU_SEARCH_INDEX_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#ifndef HAVE_MENU_CACHE
+#include "menusnapshot.h"
+#endif
+
+class QAction;
+class QMenu;
+class LaunchHistory;
+
+/*! \brief Search index of the applications in the main menu
+ *
+ * The index is built once for every (re)built menu and holds, for each
+ * application, the normalized (case folded, diacritics stripped) name,
+ * generic name, keywords, comment and executable. Lookup goes through a
+ * trigram table, so no desktop file is touched while the user types.
+ *
+ * The entries carry everything needed for presenting and launching the
+ * applications, so the search doesn't need the (sub)menus to exist.
+ *
+ * For the search view the matches are ranked (fuzzy matching of the name,
+ * boosted by the launch history).
+ *
+ * When the menu changes, the index is updated in place: only the entries
+ * of the added, removed or changed applications are touched. The removed
+ * entries are just marked and dropped by a compaction once they make up
+ * the half of the index.
+ */
+class MenuSearchIndex
+{
+public:
+    struct Entry
+    {
+        QString id; //!< desktop file
+        QString title; //!< presented name
+        QString toolTip;
+        QString icon; //!< icon name or path
+        QString name; //!< normalized name
+        QString text; //!< normalized fields, separated by '\n'
+        bool duplicate; //!< other entry with the same desktop file was added before
+        bool removed; //!< the application is not in the menu anymore
+        uint source; //!< hash of the data the entry was made of
+    };
+
+public:
+    /*! \brief Remove all entries from the index
+     */
+    void clear();
+#ifdef HAVE_MENU_CACHE
+    /*! \brief Index all applications (recursively) found in \param menu
+     */
+    void build(QMenu * menu);
+#else
+    /*! \brief Make the index match the applications (recursively) found in \param menu
+     *
+     * The entries of the applications already indexed (with the same data)
+     * are kept untouched.
+     */
+    void update(MenuSnapshot::Item const & menu);
+#endif
+    /*! \brief Return the desktop files of the applications matching the \param filter
+     *
+     * Every entry containing the (normalized) filter as a substring
+     * of any of its indexed fields matches.
+     */
+    QSet<QString> match(QString const & filter) const;
+    /*! \brief Return (at most) \param count best matching entries for the \param filter
+     *
+     * The result is ordered from the best match and contains one entry
+     * per desktop file.
+     */
+    QVector<int> rank(QString const & filter, int count) const;
+    /*! \brief Return the entry on \param index
+     */
+    Entry const & entry(int index) const { return mEntries.at(index); }
+    /*! \brief Set the launch history used for boosting the ranked results
+     */
+    void setLaunchHistory(LaunchHistory const * history);
+
+    /*! \brief Return the desktop file of the application \param action
+     */
+    static QString actionId(QAction const * action);
+
+    /*! \brief Fold the \param str for case and accent insensitive matching
+     */
+    static QString normalize(QString const & str);
+
+private:
+    void addEntry(Entry && entry, QStringList fields);
+    void insertEntry(Entry && entry);
+    void removeEntry(int index);
+    void compact();
+    int score(QString const & needle, Entry const & entry) const;
+
+    QVector<Entry> mEntries;
+    QHash<quint64, QVector<int>> mTrigrams; //!< trigram -> sorted entry indexes
+    QHash<QString, QVector<int>> mIds; //!< desktop file -> (not removed) entry indexes
+    int mRemoved = 0;
+    LaunchHistory const * mLaunchHistory = nullptr;
+};
+
+#endif //MENU_SEARCH_INDEX_H
@@ -0,0 +1,294 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "menusnapshot.h"
+
+#include <XdgMenu>
+#include <XdgDesktopFile>
+#include <XdgDirs>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDomElement>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+namespace
+{
+    constexpr quint32 CACHE_MAGIC = 0x4c514d53; // "LQMS"
+    constexpr quint32 CACHE_VERSION = 1;
+    // the least serialized sizes: a null QString, an Item with null strings and no children
+    constexpr qint64 MIN_STRING_SIZE = 4;
+    constexpr qint64 MIN_ITEM_SIZE = 1 + 6 * MIN_STRING_SIZE + 2 * 4 + 4;
+
+    QString cacheFileName(QString const & menuFile)
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + QStringLiteral("/lxqt-panel/mainmenu-%1.cache")
+            .arg(QString::fromLatin1(QCryptographicHash::hash(menuFile.toUtf8(), QCryptographicHash::Md5).toHex()));
+    }
+
+    qint64 modificationTime(QString const & path)
+    {
+        const QFileInfo info{path};
+        return info.exists() ? info.lastModified().toMSecsSinceEpoch() : -1;
+    }
+
+    void writeItem(QDataStream & out, MenuSnapshot::Item const & item)
+    {
+        out << static_cast<quint8>(item.type) << item.title << item.genericName << item.comment
+            << item.icon << item.desktopFile << item.exec << item.keywords << item.categories
+            << static_cast<quint32>(item.children.size());
+        for (auto const & child : item.children)
+            writeItem(out, child); //recursion
+    }
+
+    /*! Reads the count of a list (serialized the same way as the QDataStream does)
+     * \return false if the rest of the stream can't hold so many elements of
+     * the \param minSize, so a corrupted cache can't make us allocate an excess of memory
+     */
+    bool readCount(QDataStream & in, quint32 & count, qint64 minSize)
+    {
+        in >> count;
+        return in.status() == QDataStream::Ok && count <= in.device()->bytesAvailable() / minSize;
+    }
+
+    template <typename List>
+    bool readList(QDataStream & in, List & list, qint64 minSize)
+    {
+        quint32 count;
+        if (!readCount(in, count, minSize))
+            return false;
+        list.clear();
+        list.reserve(count);
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i)
+        {
+            typename List::value_type value;
+            in >> value;
+            list.append(value);
+        }
+        return in.status() == QDataStream::Ok;
+    }
+
+    bool readItem(QDataStream & in, MenuSnapshot::Item & item)
+    {
+        quint8 type;
+        quint32 count;
+        in >> type >> item.title >> item.genericName >> item.comment
+            >> item.icon >> item.desktopFile >> item.exec;
+        if (!readList(in, item.keywords, MIN_STRING_SIZE)
+                || !readList(in, item.categories, MIN_STRING_SIZE)
+                || !readCount(in, count, MIN_ITEM_SIZE)
+                || MenuSnapshot::Item::Separator < type)
+            return false;
+        item.type = static_cast<MenuSnapshot::Item::Type>(type);
+        item.children.resize(count);
+        for (auto & child : item.children)
+        {
+            if (!readItem(in, child) || in.status() != QDataStream::Ok) //recursion
+                return false;
+        }
+        return true;
+    }
+
+    void readMenu(QDomElement const & xml, MenuSnapshot::Item & menu, QSet<QString> & dirs)
+    {
+        menu.type = MenuSnapshot::Item::Menu;
+        menu.title = xml.attribute(QStringLiteral("title"));
+        if (menu.title.isEmpty())
+            menu.title = xml.attribute(QStringLiteral("name"));
+        menu.comment = xml.attribute(QStringLiteral("comment"));
+        menu.icon = xml.attribute(QStringLiteral("icon"));
+
+        for (QDomElement element = xml.firstChildElement(); !element.isNull(); element = element.nextSiblingElement())
+        {
+            MenuSnapshot::Item item;
+            if (element.tagName() == QLatin1String("Menu"))
+            {
+                readMenu(element, item, dirs); //recursion
+            } else if (element.tagName() == QLatin1String("AppLink"))
+            {
+                item.type = MenuSnapshot::Item::Application;
+                item.title = element.attribute(QStringLiteral("title"));
+                if (item.title.isEmpty())
+                    item.title = element.attribute(QStringLiteral("name"));
+                item.genericName = element.attribute(QStringLiteral("genericName"));
+                item.comment = element.attribute(QStringLiteral("comment"));
+                item.icon = element.attribute(QStringLiteral("icon"));
+                item.desktopFile = element.attribute(QStringLiteral("desktopFile"));
+
+                // the file was already parsed (and cached) by the XdgMenu, it isn't loaded again
+                if (XdgDesktopFile const * const df = XdgDesktopFileCache::getFile(item.desktopFile))
+                {
+                    item.keywords = df->localizedValue(QStringLiteral("Keywords")).toString().split(QLatin1Char(';'), Qt::SkipEmptyParts);
+                    item.categories = df->value(QStringLiteral("Categories")).toString().split(QLatin1Char(';'), Qt::SkipEmptyParts);
+                    const QStringList exec = df->expandExecString();
+                    if (!exec.isEmpty())
+                        item.exec = exec.at(0).section(QLatin1Char('/'), -1);
+                }
+                dirs.insert(QFileInfo{item.desktopFile}.absolutePath());
+            } else if (element.tagName() == QLatin1String("Separator"))
+            {
+                item.type = MenuSnapshot::Item::Separator;
+            } else
+            {
+                continue;
+            }
+            menu.children.append(std::move(item));
+        }
+    }
+}
+
+// static
+QSharedPointer<const MenuSnapshot> MenuSnapshot::read(QString const & menuFile
+        , QString const & logDir
+        , QStringList const & environments)
+{
+    QSharedPointer<MenuSnapshot> snapshot{new MenuSnapshot};
+    snapshot->mMenuFile = menuFile;
+    snapshot->mLocale = QLocale{}.name();
+    snapshot->mEnvironments = environments;
+
+    XdgMenu xdgMenu;
+    xdgMenu.setEnvironments(environments);
+    xdgMenu.setLogDir(logDir);
+    if (!xdgMenu.read(menuFile))
+    {
+        snapshot->mErrorString = xdgMenu.errorString();
+        if (snapshot->mErrorString.isEmpty())
+            snapshot->mErrorString = QStringLiteral("Unable to read the menu file %1").arg(menuFile);
+        return snapshot;
+    }
+
+    QSet<QString> dirs;
+    readMenu(xdgMenu.xml().documentElement(), snapshot->mRoot, dirs);
+
+    // the (not yet existing) places of new applications and menu definitions
+    dirs.insert(QFileInfo{menuFile}.absolutePath());
+    dirs.insert(XdgDirs::dataHome(false) + QStringLiteral("/applications"));
+    dirs.insert(XdgDirs::dataHome(false) + QStringLiteral("/desktop-directories"));
+    dirs.insert(XdgDirs::configHome(false) + QStringLiteral("/menus/applications-merged"));
+    const QStringList data_dirs = XdgDirs::dataDirs();
+    for (auto const & dir : data_dirs)
+    {
+        dirs.insert(dir + QStringLiteral("/applications"));
+        dirs.insert(dir + QStringLiteral("/desktop-directories"));
+    }
+    for (auto const & dir : qAsConst(dirs))
+    {
+        if (QFileInfo::exists(dir))
+            snapshot->mWatchedPaths << dir;
+    }
+    snapshot->mWatchedPaths << menuFile;
+    snapshot->mWatchedPaths.sort();
+    for (auto const & path : qAsConst(snapshot->mWatchedPaths))
+        snapshot->mWatchedTimes << modificationTime(path);
+
+    return snapshot;
+}
+
+// static
+QSharedPointer<const MenuSnapshot> MenuSnapshot::load(QString const & menuFile
+        , QStringList const & environments)
+{
+    QFile file{cacheFileName(menuFile)};
+    if (!file.open(QIODevice::ReadOnly))
+        return {};
+
+    // Note: the whole snapshot is read at once (it is small), the menus are
+    // then created from it lazily upon showing
+    QDataStream in{&file};
+    in.setVersion(QDataStream::Qt_5_15);
+    quint32 magic, version;
+    in >> magic >> version;
+    if (CACHE_MAGIC != magic || CACHE_VERSION != version)
+        return {};
+
+    QSharedPointer<MenuSnapshot> snapshot{new MenuSnapshot};
+    in >> snapshot->mMenuFile >> snapshot->mLocale;
+    if (!readList(in, snapshot->mEnvironments, MIN_STRING_SIZE)
+            || !readList(in, snapshot->mWatchedPaths, MIN_STRING_SIZE)
+            || !readList(in, snapshot->mWatchedTimes, sizeof (qint64))
+            || snapshot->mMenuFile != menuFile
+            || snapshot->mLocale != QLocale{}.name()
+            || snapshot->mEnvironments != environments
+            || snapshot->mWatchedPaths.size() != snapshot->mWatchedTimes.size())
+        return {};
+
+    // (not) modified menu file/directories
+    for (int i = 0; i < snapshot->mWatchedPaths.size(); ++i)
+    {
+        if (modificationTime(snapshot->mWatchedPaths.at(i)) != snapshot->mWatchedTimes.at(i))
+            return {};
+    }
+
+    if (!readItem(in, snapshot->mRoot))
+        return {};
+    return snapshot;
+}
+
+void MenuSnapshot::save() const
+{
+    const QString file_name = cacheFileName(mMenuFile);
+    QDir{}.mkpath(QFileInfo{file_name}.absolutePath());
+    QSaveFile file{file_name};
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    QDataStream out{&file};
+    out.setVersion(QDataStream::Qt_5_15);
+    out << CACHE_MAGIC << CACHE_VERSION
+        << mMenuFile << mLocale << mEnvironments
+        << mWatchedPaths << mWatchedTimes;
+    writeItem(out, mRoot);
+    if (out.status() == QDataStream::Ok)
+        file.commit();
+}
+
+QString MenuSnapshot::Item::menuText() const
+{
+    if (!genericName.isEmpty() && genericName != title)
+        return QStringLiteral("%1 (%2)").arg(title, genericName);
+    return title;
+}
+
+bool MenuSnapshot::Item::operator ==(Item const & other) const
+{
+    return type == other.type
+        && title == other.title
+        && genericName == other.genericName
+        && comment == other.comment
+        && icon == other.icon
+        && desktopFile == other.desktopFile
+        && exec == other.exec
+        && keywords == other.keywords
+        && categories == other.categories
+        && children == other.children;
+}
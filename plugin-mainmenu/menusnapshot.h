@@ -0,0 +1,111 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#if !defined(MENU_SNAPSHOT_H)
+#define MENU_SNAPSHOT_H
+
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/*! \brief Immutable, fully resolved content of an XDG menu
+ *
+ * The snapshot is produced by read(), which parses the menu file and loads
+ * all the desktop files. It doesn't depend on any QObject, so it can be
+ * created in a worker thread and handed over to the GUI thread.
+ *
+ * A snapshot can be stored in a binary cache file by save() and reloaded by
+ * load() (without touching the menu file and desktop files) as long as none
+ * of the watchedPaths() was modified meanwhile.
+ */
+class MenuSnapshot
+{
+public:
+    struct Item
+    {
+        enum Type
+        {
+            Menu
+                , Application
+                , Separator
+        };
+
+        Type type = Separator;
+        QString title;
+        QString genericName;
+        QString comment;
+        QString icon;
+        QString desktopFile; //!< desktop file of the application
+        QString exec; //!< executable name of the application
+        QStringList keywords;
+        QStringList categories;
+        QVector<Item> children; //!< entries of the menu
+
+        /*! \brief The title with the (differing) generic name, as presented in the menu
+         */
+        QString menuText() const;
+        bool operator ==(Item const & other) const;
+        bool operator !=(Item const & other) const { return !(*this == other); }
+    };
+
+    /*! \brief Read and resolve the \param menuFile
+     *
+     * \note This is intended to be called in a worker thread.
+     */
+    static QSharedPointer<const MenuSnapshot> read(QString const & menuFile
+            , QString const & logDir
+            , QStringList const & environments);
+    /*! \brief Load the cached snapshot of the \param menuFile
+     *
+     * \return null if there is no cached snapshot or it is outdated
+     */
+    static QSharedPointer<const MenuSnapshot> load(QString const & menuFile
+            , QStringList const & environments);
+    /*! \brief Store the snapshot into the cache
+     */
+    void save() const;
+
+    bool isValid() const { return mErrorString.isEmpty(); }
+    QString const & errorString() const { return mErrorString; }
+    QString const & menuFile() const { return mMenuFile; }
+    /*! \brief The top level menu
+     */
+    Item const & root() const { return mRoot; }
+    /*! \brief Files and directories, which changes can invalidate the snapshot
+     */
+    QStringList const & watchedPaths() const { return mWatchedPaths; }
+
+private:
+    QString mMenuFile;
+    QString mLocale;
+    QStringList mEnvironments;
+    QString mErrorString;
+    Item mRoot;
+    QStringList mWatchedPaths;
+    QVector<qint64> mWatchedTimes; //!< modification times of the mWatchedPaths
+};
+
+#endif //MENU_SNAPSHOT_H
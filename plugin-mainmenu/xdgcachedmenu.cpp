@@ -46,6 +46,16 @@ XdgCachedMenuAction::XdgCachedMenuAction(MenuCacheItem* item, QObject* parent):
     {
         QString comment = QString::fromUtf8(menu_cache_item_get_comment(item));
         setToolTip(comment);
+
+        // the fields searched in by the MenuSearchIndex
+        MenuCacheApp* app = MENU_CACHE_APP(item);
+        genericName_ = QString::fromUtf8(menu_cache_app_get_generic_name(app));
+        if (const char* const* keywords = menu_cache_app_get_keywords(app))
+        {
+            for (; *keywords; ++keywords)
+                keywords_ << QString::fromUtf8(*keywords);
+        }
+        exec_ = QString::fromUtf8(menu_cache_app_get_exec(app)).section(QLatin1Char(' '), 0, 0, QString::SectionSkipEmpty).section(QLatin1Char('/'), -1);
     }
     if (char * file_path = menu_cache_item_get_file_path(item))
     {
@@ -54,31 +64,20 @@ XdgCachedMenuAction::XdgCachedMenuAction(MenuCacheItem* item, QObject* parent):
     }
 }
 
-void XdgCachedMenuAction::updateIcon()
-{
-    if(icon().isNull())
-    {
-        // Note: We don't use the QIcon::fromTheme(const QString &name
-        // , const QIcon &fallback) overload because of "availableSizes()"
-        // check in it, see https://bugreports.qt.io/browse/QTBUG-63187
-        QIcon icon = QIcon::fromTheme(iconName_);
-
-        if (icon.isNull())
-            icon = QIcon::fromTheme(QStringLiteral("unknown"));
-        // Some themes may lack the "unknown" icon; checking null prevents 
-        // infinite recursion (setIcon->dataChanged->updateIcon->setIcon)
-        if (icon.isNull())
-            return;
-        setIcon(icon);
-    }
-}
-
-XdgCachedMenu::XdgCachedMenu(QWidget* parent): QMenu(parent)
+XdgCachedMenu::XdgCachedMenu(MenuIconLoader* iconLoader, QWidget* parent): QMenu(parent)
+    , mIconLoader(iconLoader)
+    , menu_cache_desktop_(0)
 {
     connect(this, &QMenu::aboutToShow, this, &XdgCachedMenu::onAboutToShow);
+    connect(this, &QMenu::hovered, this, [] (QAction* action) {
+        if (XdgCachedMenu* submenu = qobject_cast<XdgCachedMenu*>(action->menu()))
+            submenu->prefetchIcons();
+    });
+    connect(mIconLoader, &MenuIconLoader::iconLoaded, this, &XdgCachedMenu::onIconLoaded);
+    connect(mIconLoader, &MenuIconLoader::iconsReset, this, &XdgCachedMenu::onIconsReset);
 }
 
-XdgCachedMenu::XdgCachedMenu(MenuCache* menuCache, QWidget* parent): QMenu(parent)
+XdgCachedMenu::XdgCachedMenu(MenuCache* menuCache, MenuIconLoader* iconLoader, QWidget* parent): XdgCachedMenu(iconLoader, parent)
 {
     // qDebug() << "CREATE MENU FROM CACHE" << menuCache;
     MenuCacheDir* dir = menu_cache_dup_root_dir(menuCache);
@@ -90,7 +89,6 @@ XdgCachedMenu::XdgCachedMenu(MenuCache* menuCache, QWidget* parent): QMenu(paren
 
     addMenuItems(this, dir);
     menu_cache_item_unref(MENU_CACHE_ITEM(dir));
-    connect(this, &QMenu::aboutToShow, this, &XdgCachedMenu::onAboutToShow);
 }
 
 XdgCachedMenu::~XdgCachedMenu()
@@ -131,7 +129,7 @@ void XdgCachedMenu::addMenuItems(QMenu* menu, MenuCacheDir* dir)
         connect(action, &QAction::triggered, this, &XdgCachedMenu::onItemTriggered);
       else if(type == MENU_CACHE_TYPE_DIR)
       {
-        XdgCachedMenu* submenu = new XdgCachedMenu(menu);
+        XdgCachedMenu* submenu = new XdgCachedMenu(mIconLoader, menu);
         action->setMenu(submenu);
         addMenuItems(submenu, MENU_CACHE_DIR(item));
       }
@@ -200,17 +198,54 @@ void XdgCachedMenu::handleMouseMoveEvent(QMouseEvent *event)
     drag->exec(Qt::CopyAction | Qt::LinkAction);
 }
 
+void XdgCachedMenu::prefetchIcons()
+{
+    QStringList names;
+    const auto actionList = actions();
+    for(QAction* action : actionList)
+    {
+        if(XdgCachedMenuAction* cached_action = qobject_cast<XdgCachedMenuAction*>(action))
+            names << cached_action->iconName();
+    }
+    mIconLoader->prefetch(names);
+}
+
 void XdgCachedMenu::onAboutToShow()
 {
+    // the icons not loaded yet are set upon the iconLoaded()
     const auto actionList = actions();
     for(QAction* action : actionList)
     {
-        if(action->inherits("XdgCachedMenuAction"))
+        XdgCachedMenuAction* cached_action = qobject_cast<XdgCachedMenuAction*>(action);
+        if(cached_action && cached_action->icon().isNull())
         {
-            static_cast<XdgCachedMenuAction*>(action)->updateIcon();
-
-            // this seems to cause some incorrect menu behaviour.
-            // qApp->processEvents();
+            const QIcon icon = mIconLoader->icon(cached_action->iconName());
+            if(!icon.isNull())
+                cached_action->setIcon(icon);
         }
     }
 }
+
+void XdgCachedMenu::onIconLoaded(const QString & name, const QIcon & icon)
+{
+    const auto actionList = actions();
+    for(QAction* action : actionList)
+    {
+        XdgCachedMenuAction* cached_action = qobject_cast<XdgCachedMenuAction*>(action);
+        if(cached_action && cached_action->iconName() == name && cached_action->icon().isNull())
+            cached_action->setIcon(icon);
+    }
+}
+
+void XdgCachedMenu::onIconsReset()
+{
+    // the icons are set again upon showing the menu
+    const auto actionList = actions();
+    for(QAction* action : actionList)
+    {
+        if(XdgCachedMenuAction* cached_action = qobject_cast<XdgCachedMenuAction*>(action))
+            cached_action->setIcon(QIcon{});
+    }
+    if(isVisible())
+        onAboutToShow();
+}
@@ -23,6 +23,8 @@
 
 #include <menu-cache/menu-cache.h>
 #include <QMenu>
+#include <QStringList>
+#include "menuiconloader.h"
 
 class QEvent;
 class QMouseEvent;
@@ -31,10 +33,13 @@ class XdgCachedMenu : public QMenu
 {
     Q_OBJECT
 public:
-    XdgCachedMenu(QWidget* parent = nullptr);
-    XdgCachedMenu(MenuCache* menuCache, QWidget* parent);
+    XdgCachedMenu(MenuIconLoader* iconLoader, QWidget* parent = nullptr);
+    XdgCachedMenu(MenuCache* menuCache, MenuIconLoader* iconLoader, QWidget* parent);
     virtual ~XdgCachedMenu();
 
+    // start loading the icons of the entries of this menu
+    void prefetchIcons();
+
 protected:
     bool event(QEvent* event);
 
@@ -43,10 +48,13 @@ private:
     void handleMouseMoveEvent(QMouseEvent *event);
 
 private Q_SLOTS:
-    void onItemTrigerred();
+    void onItemTriggered();
     void onAboutToShow();
+    void onIconLoaded(const QString & name, const QIcon & icon);
+    void onIconsReset();
 
 private:
+    MenuIconLoader* mIconLoader;
     QPoint mDragStartPosition;
     guint32 menu_cache_desktop_;
 };
@@ -57,12 +65,18 @@ class XdgCachedMenuAction: public QAction
 public:
     explicit XdgCachedMenuAction(MenuCacheItem* item, QObject* parent = nullptr);
     inline const QString & filePath() const { return filePath_; }
-
-    void updateIcon();
+    inline const QString & iconName() const { return iconName_; }
+    inline const QString & genericName() const { return genericName_; }
+    inline const QStringList & keywords() const { return keywords_; }
+    //! \return the basename of the executable
+    inline const QString & exec() const { return exec_; }
 
 private:
     QString iconName_;
     QString filePath_;
+    QString genericName_;
+    QStringList keywords_;
+    QString exec_;
 };
 
 
@@ -0,0 +1,332 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "xdgsnapshotmenu.h"
+#include <QDrag>
+#include <QHash>
+#include <QSet>
+#include <QMouseEvent>
+#include <QApplication>
+#include <XdgDesktopFile>
+#include <QHelpEvent>
+#include <QMimeData>
+#include <QToolTip>
+#include <QUrl>
+
+XdgSnapshotMenuAction::XdgSnapshotMenuAction(MenuSnapshot::Item const & item, QObject* parent):
+    QAction{parent}
+{
+    setItem(item);
+}
+
+void XdgSnapshotMenuAction::setItem(MenuSnapshot::Item const & item)
+{
+    if (item.icon != mItem.icon)
+        setIcon(QIcon{}); // set again upon showing the menu
+    mItem = item;
+    QString title = mItem.menuText();
+    title = title.replace(QLatin1Char('&'), QLatin1String("&&")); // & is reserved for mnemonics
+    setText(title);
+    // Only set tooltips for app items
+    if (mItem.type == MenuSnapshot::Item::Application)
+        setToolTip(mItem.comment);
+}
+
+XdgSnapshotMenu::XdgSnapshotMenu(MenuSnapshot::Item const & menu, MenuIconLoader * iconLoader, QWidget* parent)
+    : QMenu(parent)
+    , mItem{menu}
+    , mIconLoader{iconLoader}
+    , mMaterialized{false}
+{
+    connect(this, &QMenu::aboutToShow, this, &XdgSnapshotMenu::onAboutToShow);
+    // the user is probably going to open the hovered submenu
+    connect(this, &QMenu::hovered, this, [] (QAction * action) {
+        if (XdgSnapshotMenu * submenu = qobject_cast<XdgSnapshotMenu *>(action->menu()))
+            submenu->prefetchIcons();
+    });
+}
+
+void XdgSnapshotMenu::prefetchIcons()
+{
+    QStringList names;
+    for (auto const & item : mItem.children)
+    {
+        if (MenuSnapshot::Item::Separator != item.type)
+            names << item.icon;
+    }
+    mIconLoader->prefetch(names);
+}
+
+XdgSnapshotMenu::~XdgSnapshotMenu()
+{
+}
+
+void XdgSnapshotMenu::materialize()
+{
+    mMaterialized = true;
+    connect(mIconLoader, &MenuIconLoader::iconLoaded, this, &XdgSnapshotMenu::onIconLoaded);
+    connect(mIconLoader, &MenuIconLoader::iconsReset, this, &XdgSnapshotMenu::onIconsReset);
+    for (auto const & item : mItem.children)
+    {
+        QAction * action = createEntry(item);
+        addAction(action);
+        mEntries << action;
+    }
+}
+
+void XdgSnapshotMenu::ensureMaterialized()
+{
+    if (!mMaterialized)
+        materialize();
+}
+
+QAction * XdgSnapshotMenu::createEntry(MenuSnapshot::Item const & item)
+{
+    if (MenuSnapshot::Item::Separator == item.type)
+    {
+        QAction * action = new QAction(this);
+        action->setSeparator(true);
+        return action;
+    }
+
+    XdgSnapshotMenuAction* action = new XdgSnapshotMenuAction(item, this);
+    if (MenuSnapshot::Item::Application == item.type)
+    {
+        connect(action, &QAction::triggered, this, &XdgSnapshotMenu::onItemTriggered);
+    } else
+    {
+        XdgSnapshotMenu* submenu = new XdgSnapshotMenu(item, mIconLoader, this);
+        submenu->setTitle(action->text());
+        action->setMenu(submenu);
+        connect(submenu, &XdgSnapshotMenu::menuCreated, this, &XdgSnapshotMenu::menuCreated);
+        emit menuCreated(submenu);
+    }
+    return action;
+}
+
+void XdgSnapshotMenu::update(MenuSnapshot::Item const & menu)
+{
+    if (!mMaterialized)
+    {
+        // nothing created yet
+        mItem = menu;
+        return;
+    }
+
+    // the present entries by their identity (in the menu order)
+    const auto key = [] (MenuSnapshot::Item const & item) -> QString {
+        switch (item.type)
+        {
+            case MenuSnapshot::Item::Application:
+                return QStringLiteral("A") + item.desktopFile;
+            case MenuSnapshot::Item::Menu:
+                return QStringLiteral("M") + item.title;
+            default:
+                return QStringLiteral("S");
+        }
+    };
+    QHash<QString, QList<QAction *>> unmatched;
+    for (int i = 0, i_e = mEntries.size(); i < i_e; ++i)
+        unmatched[key(mItem.children.at(i))] << mEntries.at(i);
+
+    QList<QAction *> entries;
+    for (auto const & item : menu.children)
+    {
+        QAction * action = nullptr;
+        const auto candidates = unmatched.find(key(item));
+        if (candidates != unmatched.end() && !candidates->isEmpty())
+            action = candidates->takeFirst();
+
+        if (nullptr == action)
+        {
+            action = createEntry(item);
+        } else if (XdgSnapshotMenuAction * snapshot_action = qobject_cast<XdgSnapshotMenuAction *>(action))
+        {
+            if (snapshot_action->item() != item)
+            {
+                snapshot_action->setItem(item);
+                if (XdgSnapshotMenu * submenu = qobject_cast<XdgSnapshotMenu *>(action->menu()))
+                {
+                    submenu->setTitle(action->text());
+                    submenu->update(item); //recursion
+                }
+            }
+        }
+        entries << action;
+    }
+
+    // the actions not created by us stay after the entries
+    QAction * before = nullptr;
+    const QSet<QAction *> old_entries{mEntries.cbegin(), mEntries.cend()};
+    const auto present = actions();
+    for (QAction * action : present)
+    {
+        if (!old_entries.contains(action))
+        {
+            before = action;
+            break;
+        }
+    }
+
+    for (auto const & removed : qAsConst(unmatched))
+    {
+        for (QAction * action : removed)
+        {
+            delete action->menu();
+            delete action;
+        }
+    }
+
+    // put the entries in order (from the last one), moving just the misplaced
+    // ones; the \c current mirrors the actions(), \c pos is the index of \c before
+    QList<QAction *> current = actions();
+    int pos = nullptr == before ? current.size() : current.indexOf(before);
+    for (int i = entries.size() - 1; 0 <= i; --i)
+    {
+        QAction * action = entries.at(i);
+        if (0 < pos && current.at(pos - 1) == action)
+        {
+            --pos;
+        } else
+        {
+            insertAction(before, action);
+            const int from = current.indexOf(action);
+            if (0 <= from)
+            {
+                current.removeAt(from);
+                if (from < pos)
+                    --pos;
+            }
+            current.insert(pos, action);
+        }
+        before = action;
+    }
+
+    mItem = menu;
+    mEntries = entries;
+}
+
+void XdgSnapshotMenu::onItemTriggered()
+{
+    XdgSnapshotMenuAction* action = static_cast<XdgSnapshotMenuAction*>(sender());
+    XdgDesktopFile df;
+    if (df.load(action->filePath()))
+        df.startDetached();
+}
+
+// taken from libqtxdg: XdgMenuWidget
+bool XdgSnapshotMenu::event(QEvent* event)
+{
+    if (event->type() == QEvent::MouseButtonPress)
+    {
+        QMouseEvent *e = static_cast<QMouseEvent*>(event);
+        if (e->button() == Qt::LeftButton)
+            mDragStartPosition = e->pos();
+    }
+
+    else if (event->type() == QEvent::MouseMove)
+    {
+        QMouseEvent *e = static_cast<QMouseEvent*>(event);
+        handleMouseMoveEvent(e);
+    }
+
+    else if(event->type() == QEvent::ToolTip)
+    {
+        QHelpEvent* helpEvent = static_cast<QHelpEvent*>(event);
+        QAction* action = actionAt(helpEvent->pos());
+        if(action && action->menu() == nullptr)
+            QToolTip::showText(helpEvent->globalPos(), action->toolTip(), this);
+    }
+
+    return QMenu::event(event);
+}
+
+// taken from libqtxdg: XdgMenuWidget
+void XdgSnapshotMenu::handleMouseMoveEvent(QMouseEvent *event)
+{
+    if (!(event->buttons() & Qt::LeftButton))
+        return;
+
+    if ((event->pos() - mDragStartPosition).manhattanLength() < QApplication::startDragDistance())
+        return;
+
+    XdgSnapshotMenuAction *a = qobject_cast<XdgSnapshotMenuAction*>(actionAt(mDragStartPosition));
+    if (!a || a->filePath().isEmpty())
+        return;
+
+    QList<QUrl> urls;
+    urls << QUrl::fromLocalFile(a->filePath());
+
+    QMimeData *mimeData = new QMimeData();
+    mimeData->setUrls(urls);
+
+    QDrag *drag = new QDrag(this);
+    drag->setMimeData(mimeData);
+    drag->exec(Qt::CopyAction | Qt::LinkAction);
+}
+
+void XdgSnapshotMenu::onAboutToShow()
+{
+    ensureMaterialized();
+
+    // the icons not loaded yet are set upon the iconLoaded()
+    const auto actionList = actions();
+    for (QAction* action : actionList)
+    {
+        if (XdgSnapshotMenuAction* snapshot_action = qobject_cast<XdgSnapshotMenuAction*>(action))
+        {
+            if (snapshot_action->icon().isNull())
+            {
+                const QIcon icon = mIconLoader->icon(snapshot_action->item().icon);
+                if (!icon.isNull())
+                    snapshot_action->setIcon(icon);
+            }
+        }
+    }
+}
+
+void XdgSnapshotMenu::onIconLoaded(QString const & name, QIcon const & icon)
+{
+    const auto actionList = actions();
+    for (QAction* action : actionList)
+    {
+        XdgSnapshotMenuAction* snapshot_action = qobject_cast<XdgSnapshotMenuAction*>(action);
+        if (nullptr != snapshot_action && snapshot_action->item().icon == name && snapshot_action->icon().isNull())
+            snapshot_action->setIcon(icon);
+    }
+}
+
+void XdgSnapshotMenu::onIconsReset()
+{
+    // the icons are set again upon showing the menu
+    const auto actionList = actions();
+    for (QAction* action : actionList)
+    {
+        if (XdgSnapshotMenuAction* snapshot_action = qobject_cast<XdgSnapshotMenuAction*>(action))
+            snapshot_action->setIcon(QIcon{});
+    }
+    if (isVisible())
+        onAboutToShow();
+}
@@ -0,0 +1,117 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef XDGSNAPSHOTMENU_H
+#define XDGSNAPSHOTMENU_H
+
+#include "menusnapshot.h"
+#include "menuiconloader.h"
+#include <QMenu>
+#include <QAction>
+
+class QEvent;
+class QMouseEvent;
+
+/*! \brief Menu built from the MenuSnapshot
+ *
+ * Counterpart of the XdgCachedMenu for the menus read by XdgMenu: the
+ * desktop files are loaded only when an application is launched and the
+ * icons are loaded (by the MenuIconLoader) upon showing/hovering the menu.
+ *
+ * No entries are created upon construction, the top level menu is filled
+ * by ensureMaterialized() (after connecting to the menuCreated()) and the
+ * submenus are filled on their first showing.
+ *
+ * A new snapshot of the menu is applied by update(), which touches only
+ * the entries that were added, removed or changed.
+ */
+class XdgSnapshotMenu : public QMenu
+{
+    Q_OBJECT
+public:
+    XdgSnapshotMenu(MenuSnapshot::Item const & menu, MenuIconLoader * iconLoader, QWidget* parent);
+    virtual ~XdgSnapshotMenu();
+
+    /*! \brief Start loading the icons of the entries of this menu
+     */
+    void prefetchIcons();
+
+    /*! \brief Bring the menu (recursively) up to date with the \param menu
+     *
+     * The entries not changed are kept (together with their icons) and
+     * the actions not created by this menu are kept after its entries.
+     */
+    void update(MenuSnapshot::Item const & menu);
+
+    inline MenuSnapshot::Item const & item() const { return mItem; }
+    /*! \brief Are the entries of this menu created already?
+     */
+    inline bool isMaterialized() const { return mMaterialized; }
+    /*! \brief Create the entries of this menu, if not done yet
+     */
+    void ensureMaterialized();
+
+Q_SIGNALS:
+    /*! \brief A (not yet materialized) submenu was created in this menu or in
+     * any of its submenus
+     */
+    void menuCreated(QMenu * menu);
+
+protected:
+    bool event(QEvent* event);
+
+private:
+    void materialize();
+    QAction * createEntry(MenuSnapshot::Item const & item);
+    void handleMouseMoveEvent(QMouseEvent *event);
+
+private Q_SLOTS:
+    void onItemTriggered();
+    void onAboutToShow();
+    void onIconLoaded(QString const & name, QIcon const & icon);
+    void onIconsReset();
+
+private:
+    MenuSnapshot::Item mItem;
+    MenuIconLoader * mIconLoader;
+    bool mMaterialized;
+    QList<QAction *> mEntries; //!< actions created for the mItem.children
+    QPoint mDragStartPosition;
+};
+
+class XdgSnapshotMenuAction: public QAction
+{
+    Q_OBJECT
+public:
+    explicit XdgSnapshotMenuAction(MenuSnapshot::Item const & item, QObject* parent = nullptr);
+    inline MenuSnapshot::Item const & item() const { return mItem; }
+    inline QString const & filePath() const { return mItem.desktopFile; }
+    void setItem(MenuSnapshot::Item const & item);
+
+private:
+    MenuSnapshot::Item mItem;
+};
+
+#endif // XDGSNAPSHOTMENU_H
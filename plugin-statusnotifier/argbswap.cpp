@@ -0,0 +1,97 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "argbswap.h"
+
+#include <QtEndian>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ARGBSWAP_X86
+#endif
+
+namespace
+{
+    void swapScalar(uchar *data, qsizetype pixels)
+    {
+        for (uchar *p = data, *end = data + pixels * 4; p < end; p += 4)
+            qToUnaligned(qFromBigEndian<quint32>(p), p);
+    }
+
+#if defined(ARGBSWAP_X86)
+    __attribute__((target("ssse3")))
+    void swapSsse3(uchar *data, qsizetype pixels)
+    {
+        const __m128i mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+        qsizetype i = 0;
+        for (; i + 4 <= pixels; i += 4)
+        {
+            __m128i *p = reinterpret_cast<__m128i *>(data + i * 4);
+            _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), mask));
+        }
+        swapScalar(data + i * 4, pixels - i);
+    }
+
+    __attribute__((target("avx2")))
+    void swapAvx2(uchar *data, qsizetype pixels)
+    {
+        // the shuffle works within the 128-bit lanes
+        const __m256i mask = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3
+                , 12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3);
+        qsizetype i = 0;
+        for (; i + 8 <= pixels; i += 8)
+        {
+            __m256i *p = reinterpret_cast<__m256i *>(data + i * 4);
+            _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p), mask));
+        }
+        swapScalar(data + i * 4, pixels - i);
+    }
+#endif
+
+    using SwapFunction = void (*)(uchar *, qsizetype);
+
+    SwapFunction selectSwap()
+    {
+#if defined(ARGBSWAP_X86)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return swapAvx2;
+        if (__builtin_cpu_supports("ssse3"))
+            return swapSsse3;
+#endif
+        return swapScalar;
+    }
+}
+
+void swapArgbByteOrder(uchar *data, qsizetype pixels)
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    Q_UNUSED(data)
+    Q_UNUSED(pixels)
+#else
+    static const SwapFunction swap = selectSwap();
+    swap(data, pixels);
+#endif
+}
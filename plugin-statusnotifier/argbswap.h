@@ -0,0 +1,36 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QtGlobal>
+
+/*! \brief Swap the byte order of \param pixels 32-bit ARGB pixels in \param data in place
+ *
+ * Converts the (network byte order) pixel data of the SNI IconPixmap into
+ * QImage::Format_ARGB32 on little-endian hosts (and back), no-op on big-endian
+ * ones. The SSSE3/AVX2 shuffle is used when the CPU supports it.
+ */
+void swapArgbByteOrder(uchar *data, qsizetype pixels);
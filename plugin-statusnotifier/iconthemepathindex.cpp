@@ -0,0 +1,181 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "iconthemepathindex.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent>
+
+IconThemePathIndex::IconThemePathIndex(QObject *parent)
+    : QObject(parent)
+{
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &IconThemePathIndex::onDirectoryChanged);
+}
+
+bool IconThemePathIndex::find(const QString &themePath, const QString &iconName, QStringList &files)
+{
+    const auto index = mIndexes.constFind(themePath);
+    if (index == mIndexes.cend())
+    {
+        build(themePath);
+        return false;
+    }
+
+    const QHash<QString, QStringList> & names = (*index)->files;
+    const bool hasExtension = iconName.endsWith(QStringLiteral(".png"))
+                              || iconName.endsWith(QStringLiteral(".svg"))
+                              || iconName.endsWith(QStringLiteral(".xpm"));
+    if (hasExtension)
+    { // extension is included
+        files = names.value(iconName);
+    }
+    else
+    {
+        files = names.value(iconName + QStringLiteral(".png"))
+            + names.value(iconName + QStringLiteral(".svg"))
+            + names.value(iconName + QStringLiteral(".xpm"));
+    }
+    return true;
+}
+
+void IconThemePathIndex::build(const QString &themePath)
+{
+    if (mBuilding.contains(themePath))
+        return;
+    mBuilding.insert(themePath);
+
+    QFutureWatcher<Index> * future_watcher = new QFutureWatcher<Index>{this};
+    connect(future_watcher, &QFutureWatcher<Index>::finished, this, [this, future_watcher, themePath]
+        {
+            future_watcher->deleteLater();
+            mBuilding.remove(themePath);
+
+            mIndexes.insert(themePath, QSharedPointer<const Index>{new Index{future_watcher->result()}});
+            updateWatchedDirs();
+
+            if (mOutdated.remove(themePath))
+                build(themePath);
+            emit indexed(themePath);
+        });
+    future_watcher->setFuture(QtConcurrent::run(&IconThemePathIndex::list, themePath));
+}
+
+void IconThemePathIndex::onDirectoryChanged(const QString &dir)
+{
+    for (auto i = mIndexes.cbegin(), i_e = mIndexes.cend(); i != i_e; ++i)
+    {
+        if (!i.value()->dirs.contains(dir))
+            continue;
+        const QString themePath = i.key();
+        if (mBuilding.contains(themePath))
+        {
+            mOutdated.insert(themePath);
+        } else if (!mScheduled.contains(themePath))
+        {
+            // let the (un)installation finish, the old index serves meanwhile
+            mScheduled.insert(themePath);
+            QTimer::singleShot(500, this, [this, themePath] {
+                mScheduled.remove(themePath);
+                build(themePath);
+            });
+        }
+    }
+}
+
+void IconThemePathIndex::updateWatchedDirs()
+{
+    // the indexes can share directories (e.g. the parent of not existing paths)
+    QSet<QString> dirs;
+    for (const auto &index : qAsConst(mIndexes))
+    {
+        for (const QString &dir : index->dirs)
+            dirs.insert(dir);
+    }
+
+    const QStringList watched = mWatcher.directories();
+    QStringList removed;
+    for (const QString &dir : watched)
+    {
+        if (!dirs.remove(dir))
+            removed << dir;
+    }
+    if (!removed.isEmpty())
+        mWatcher.removePaths(removed);
+    if (!dirs.isEmpty())
+        mWatcher.addPaths(dirs.values());
+}
+
+IconThemePathIndex::Index IconThemePathIndex::list(const QString &themePath)
+{
+    static const QStringList filters = {
+        QStringLiteral("*.png")
+        , QStringLiteral("*.svg")
+        , QStringLiteral("*.xpm")
+    };
+
+    Index index;
+    const auto add_dir = [&index] (const QDir &dir) {
+        index.dirs << dir.absolutePath();
+        const QStringList names = dir.entryList(filters, QDir::Files);
+        for (const QString &name : names)
+            index.files[name] << dir.filePath(name);
+    };
+
+    QDir themeDir(themePath);
+    if (!themeDir.exists())
+    {
+        // the path is indexed again once it's created
+        QString dir = QDir::cleanPath(themeDir.absolutePath());
+        while (!QFileInfo::exists(dir))
+        {
+            const QString parent = QFileInfo(dir).absolutePath();
+            if (parent == dir)
+                return index;
+            dir = parent;
+        }
+        index.dirs << dir;
+        return index;
+    }
+    add_dir(themeDir);
+
+    if (themeDir.cd(QStringLiteral("hicolor")) || (themeDir.cd(QStringLiteral("icons")) && themeDir.cd(QStringLiteral("hicolor"))))
+    {
+        // the size and context directories are watched for new contexts
+        index.dirs << themeDir.absolutePath();
+        const QStringList sizes = themeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+        for (const QString &size : sizes)
+        {
+            const QDir sizeDir(themeDir.filePath(size));
+            index.dirs << sizeDir.absolutePath();
+            const QStringList contexts = sizeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
+            for (const QString &context : contexts)
+                add_dir(QDir(sizeDir.filePath(context)));
+        }
+    }
+    return index;
+}
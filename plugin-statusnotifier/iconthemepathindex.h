@@ -0,0 +1,78 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QSharedPointer>
+#include <QStringList>
+
+/*! \brief Index of the icon files the SNI items ship in their IconThemePath
+ *
+ * The theme path (and its hicolor/<size>/<context> directories) is listed
+ * just once, in a worker thread, so the lookup of an icon is a hash hit.
+ * The listed directories are watched and the index is rebuilt (and
+ * indexed() emitted again) upon their change. For a theme path not existing
+ * yet its nearest existing parent is watched.
+ */
+class IconThemePathIndex : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit IconThemePathIndex(QObject *parent = nullptr);
+    ~IconThemePathIndex() = default;
+
+    /*! \brief Find the files of the icon \param iconName in the \param themePath
+     *
+     * \return false if the \param themePath is not indexed yet, the indexed()
+     * is emitted once it is
+     */
+    bool find(const QString &themePath, const QString &iconName, QStringList &files);
+
+signals:
+    void indexed(const QString &themePath);
+
+private:
+    struct Index
+    {
+        QHash<QString, QStringList> files; //!< file name -> paths
+        QStringList dirs; //!< the listed (or the nearest existing) directories
+    };
+
+    void build(const QString &themePath);
+    void onDirectoryChanged(const QString &dir);
+    void updateWatchedDirs();
+    static Index list(const QString &themePath);
+
+    QHash<QString, QSharedPointer<const Index>> mIndexes;
+    QSet<QString> mBuilding;
+    QSet<QString> mOutdated; //!< changed while being built
+    QSet<QString> mScheduled; //!< changed, to be built again
+    QFileSystemWatcher mWatcher;
+};
@@ -26,6 +26,7 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "sniasync.h"
+#include <memory>
 
 SniAsync::SniAsync(const QString &service, const QString &path, const QDBusConnection &connection, QObject *parent/* = 0*/)
     : QObject(parent)
@@ -46,3 +47,50 @@ QDBusPendingReply<QDBusVariant> SniAsync::asyncPropGet(QString const & property)
     msg << mSni.interface() << property;
     return mSni.connection().asyncCall(msg);
 }
+
+void SniAsync::propertiesGetAllAsync(QStringList const & fallback, std::function<void (QVariantMap)> finished)
+{
+    QDBusMessage msg = QDBusMessage::createMethodCall(mSni.service(), mSni.path(), QLatin1String("org.freedesktop.DBus.Properties"), QLatin1String("GetAll"));
+    msg << mSni.interface();
+    connect(new QDBusPendingCallWatcher{mSni.connection().asyncCall(msg), this},
+            &QDBusPendingCallWatcher::finished,
+            [this, fallback, finished] (QDBusPendingCallWatcher * call)
+            {
+                call->deleteLater();
+                QDBusPendingReply<QVariantMap> reply = *call;
+                if (!reply.isError())
+                {
+                    finished(reply.value());
+                    return;
+                }
+                qDebug().noquote().nospace() << "Error on DBus request(" << mSni.service() << ',' << mSni.path() << "): " << reply.error();
+
+                if (fallback.isEmpty())
+                {
+                    finished(QVariantMap{});
+                    return;
+                }
+                struct Collected
+                {
+                    QVariantMap properties;
+                    int pending;
+                };
+                auto collected = std::make_shared<Collected>(Collected{QVariantMap{}, fallback.size()});
+                for (QString const & name : fallback)
+                {
+                    connect(new QDBusPendingCallWatcher{asyncPropGet(name), this},
+                            &QDBusPendingCallWatcher::finished,
+                            [collected, finished, name] (QDBusPendingCallWatcher * call)
+                            {
+                                QDBusPendingReply<QVariant> reply = *call;
+                                if (!reply.isError())
+                                    collected->properties.insert(name, reply.value());
+                                call->deleteLater();
+                                if (0 == --collected->pending)
+                                    finished(collected->properties);
+                            }
+                    );
+                }
+            }
+    );
+}
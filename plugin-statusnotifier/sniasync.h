@@ -86,6 +86,15 @@ public:
         );
     }
 
+    /*! \brief Get all the properties of the item by one GetAll call
+     *
+     * The \param finished is called with the (unmarshalled by qdbus_cast<>())
+     * properties. Some implementations fail the whole GetAll because of a
+     * single property, in such case the \param fallback properties are
+     * requested one by one (and the missing ones are left out).
+     */
+    void propertiesGetAllAsync(QStringList const & fallback, std::function<void (QVariantMap)> finished);
+
     //exposed methods from org::kde::StatusNotifierItem
     inline QString service() const { return mSni.service(); }
 
@@ -28,6 +28,9 @@
 
 #include "statusnotifier.h"
 
+#include <QPointer>
+#include <QTimer>
+
 StatusNotifier::StatusNotifier(const ILXQtPanelPluginStartupInfo &startupInfo) :
     QObject(),
     ILXQtPanelPlugin(startupInfo)
@@ -39,6 +42,16 @@ QDialog *StatusNotifier::configureDialog()
 {
     auto dialog = new StatusNotifierConfiguration(settings());
     dialog->addItems(m_widget->itemTitles());
+    // keep the shown CPU loads current
+    QPointer<StatusNotifierWidget> widget = m_widget;
+    const auto update_loads = [dialog, widget] {
+        if (widget)
+            dialog->setCpuLoads(widget->itemCpuLoads());
+    };
+    update_loads();
+    QTimer *timer = new QTimer(dialog);
+    connect(timer, &QTimer::timeout, dialog, update_loads);
+    timer->start(1000);
     return dialog;
 }
 
@@ -28,15 +28,21 @@
 
 #include "statusnotifierbutton.h"
 
-#include <QDir>
-#include <QFile>
 #include <dbusmenu-qt5/dbusmenuimporter.h>
 #include "../panel/ilxqtpanelplugin.h"
 #include "sniasync.h"
+#include "iconthemepathindex.h"
+#include "argbswap.h"
+#include <cmath>
 #include <XdgIcon>
 
 namespace
 {
+    //! the period the CPU load is averaged over (s)
+    const qreal CPU_LOAD_PERIOD = 10.0;
+    //! items spending more CPU are limited to one icon update per second
+    const qreal CPU_LOAD_BUDGET = 0.02;
+
     /*! \brief specialized DBusMenuImporter to correctly create actions' icons based
      * on name
      */
@@ -53,13 +59,22 @@ namespace
     };
 }
 
-StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin, QWidget *parent)
+StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin, IconThemePathIndex *iconThemePathIndex, QWidget *parent)
     : QToolButton(parent),
     mMenu(nullptr),
+    mMenuImporter(nullptr),
+    mMenuRevision(0),
+    mMenuFetchedRevision(0),
     mStatus(Passive),
     mFallbackIcon(QIcon::fromTheme(QLatin1String("application-x-executable"))),
     mPlugin(plugin),
-    mAutoHide(false)
+    mIconThemePathIndex(iconThemePathIndex),
+    mAutoHide(false),
+    mRefreshNeeded(0),
+    mRefreshing(false),
+    mInitialized(false),
+    mMaxIconRate(DEFAULT_ICON_RATE),
+    mCpuLoad(0)
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setAutoRaise(true);
@@ -71,36 +86,17 @@ StatusNotifierButton::StatusNotifierButton(QString service, QString objectPath,
     connect(interface, &SniAsync::NewToolTip, this, &StatusNotifierButton::newToolTip);
     connect(interface, &SniAsync::NewStatus, this, &StatusNotifierButton::newStatus);
 
-    // get the title only at the start because that title is used
-    // for deciding about (auto-)hiding
-    interface->propertyGetAsync(QLatin1String("Title"), [this] (QString value) {
-        mTitle = value;
-        QTimer::singleShot(0, this, [this]() { // wait for the c-tor
-            Q_EMIT titleFound(mTitle);
-        });
-    });
-
-    interface->propertyGetAsync(QLatin1String("Menu"), [this] (QDBusObjectPath path) {
-        if (!path.path().isEmpty())
-        {
-            mMenu = (new MenuImporter{interface->service(), path.path(), this})->menu();
-            mMenu->setObjectName(QLatin1String("StatusNotifierMenu"));
-        }
-    });
-
-    interface->propertyGetAsync(QLatin1String("Status"), [this] (QString status) {
-        newStatus(status);
-    });
-
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        //do the logic of icons after we've got the theme path
-        refetchIcon(Active, value);
-        refetchIcon(Passive, value);
-        refetchIcon(NeedsAttention, value);
+    // bursts of the change signals are served by one GetAll
+    mRefreshTimer.setSingleShot(true);
+    mRefreshTimer.setInterval(0);
+    connect(&mRefreshTimer, &QTimer::timeout, this, &StatusNotifierButton::refresh);
+    requestRefresh(RefreshAll);
+    // the files in the IconThemePath are (re)indexed
+    connect(mIconThemePathIndex, &IconThemePathIndex::indexed, this, [this] (const QString &themePath) {
+        if (themePath == mIconThemePath)
+            requestRefresh(RefreshIcons);
     });
 
-    newToolTip();
-
     // The timer that hides an auto-hiding button after it gets attention:
     mHideTimer.setSingleShot(true);
     mHideTimer.setInterval(300000);
@@ -120,30 +116,178 @@ void StatusNotifierButton::newIcon()
     if (!icon().isNull() && icon().name() != QLatin1String("application-x-executable"))
         onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(Passive, value);
-    });
+    requestRefresh(RefreshIcon);
 }
 
 void StatusNotifierButton::newOverlayIcon()
 {
     onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(Active, value);
-    });
+    requestRefresh(RefreshOverlayIcon);
 }
 
 void StatusNotifierButton::newAttentionIcon()
 {
     onNeedingAttention();
 
-    interface->propertyGetAsync(QLatin1String("IconThemePath"), [this] (QString value) {
-        refetchIcon(NeedsAttention, value);
+    requestRefresh(RefreshAttentionIcon);
+}
+
+void StatusNotifierButton::newToolTip()
+{
+    requestRefresh(RefreshToolTip);
+}
+
+void StatusNotifierButton::requestRefresh(int parts)
+{
+    mRefreshNeeded |= parts;
+    // the running request triggers the next one upon its reply
+    if (mRefreshing)
+        return;
+    // the scheduled one serves these parts too, but the parts not being rate
+    // limited (e.g. the tooltip) must not wait for the delayed icons
+    const int delay = refreshDelay();
+    if (!mRefreshTimer.isActive() || delay < mRefreshTimer.remainingTime())
+        mRefreshTimer.start(delay);
+}
+
+int StatusNotifierButton::refreshDelay() const
+{
+    if (0 != (mRefreshNeeded & ~RefreshIcons))
+        return 0;
+    return iconRefreshDelay();
+}
+
+int StatusNotifierButton::iconRefreshDelay() const
+{
+    if (!mLastIconRefresh.isValid())
+        return 0;
+
+    int interval = 1000 / mMaxIconRate;
+    // don't let a misbehaving item keep the panel busy
+    if (cpuLoad() > CPU_LOAD_BUDGET)
+        interval = qMax(interval, 1000);
+    return qMax(0, interval - static_cast<int>(mLastIconRefresh.elapsed()));
+}
+
+void StatusNotifierButton::refresh()
+{
+    static const QStringList properties = {
+        QStringLiteral("Title")
+        , QStringLiteral("Menu")
+        , QStringLiteral("Status")
+        , QStringLiteral("IconThemePath")
+        , QStringLiteral("IconName")
+        , QStringLiteral("IconPixmap")
+        , QStringLiteral("OverlayIconName")
+        , QStringLiteral("OverlayIconPixmap")
+        , QStringLiteral("AttentionIconName")
+        , QStringLiteral("AttentionIconPixmap")
+        , QStringLiteral("ToolTip")
+    };
+
+    int parts = mRefreshNeeded;
+    // the icons don't ride along with the other parts before their time
+    if (0 < iconRefreshDelay())
+        parts &= ~RefreshIcons;
+    if (0 == parts)
+    {
+        if (0 != mRefreshNeeded)
+            mRefreshTimer.start(refreshDelay());
+        return;
+    }
+    mRefreshNeeded &= ~parts;
+    mRefreshing = true;
+    if (parts & RefreshIcons)
+        mLastIconRefresh.start();
+    interface->propertiesGetAllAsync(properties, [this, parts] (QVariantMap properties) {
+        mRefreshing = false;
+        QElapsedTimer cost;
+        cost.start();
+        // the parts signalled as changed meanwhile are going to be fetched
+        // again, their values in this reply are stale
+        applyProperties(properties, parts & ~mRefreshNeeded);
+        addCpuCost(cost.nsecsElapsed());
+        if (0 != mRefreshNeeded)
+            mRefreshTimer.start(refreshDelay());
     });
 }
 
-void StatusNotifierButton::refetchIcon(Status status, const QString& themePath)
+void StatusNotifierButton::setMaxIconRate(int rate)
+{
+    mMaxIconRate = qBound<int>(MIN_ICON_RATE, rate, MAX_ICON_RATE);
+}
+
+qreal StatusNotifierButton::cpuLoad() const
+{
+    if (!mCpuLoadTime.isValid())
+        return 0;
+    // exponentially decaying average
+    return mCpuLoad * std::exp(-mCpuLoadTime.elapsed() / (1000 * CPU_LOAD_PERIOD));
+}
+
+void StatusNotifierButton::addCpuCost(qint64 nsecs)
+{
+    mCpuLoad = cpuLoad() + nsecs / (1e9 * CPU_LOAD_PERIOD);
+    mCpuLoadTime.start();
+}
+
+void StatusNotifierButton::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer cost;
+    cost.start();
+    QToolButton::paintEvent(event);
+    addCpuCost(cost.nsecsElapsed());
+}
+
+void StatusNotifierButton::applyProperties(const QVariantMap &properties, int parts)
+{
+    if (!mInitialized)
+    {
+        mInitialized = true;
+        // get the title only at the start because that title is used
+        // for deciding about (auto-)hiding
+        mTitle = properties.value(QStringLiteral("Title")).toString();
+        QTimer::singleShot(0, this, [this]() {
+            Q_EMIT titleFound(mTitle);
+        });
+
+        // the menu is imported upon the first hovering of the button
+        mMenuPath = qdbus_cast<QDBusObjectPath>(properties.value(QStringLiteral("Menu"))).path();
+        if (!mMenuPath.isEmpty())
+        {
+            QDBusConnection::sessionBus().connect(interface->service(), mMenuPath, QStringLiteral("com.canonical.dbusmenu")
+                    , QStringLiteral("LayoutUpdated"), this, SLOT(menuLayoutUpdated(uint,int)));
+        }
+
+        if (properties.contains(QStringLiteral("Status")))
+            newStatus(properties.value(QStringLiteral("Status")).toString());
+    }
+
+    //do the logic of icons after we've got the theme path
+    mIconThemePath = properties.value(QStringLiteral("IconThemePath")).toString();
+    if (parts & RefreshOverlayIcon)
+        updateIcon(Active, properties, mIconThemePath);
+    if (parts & RefreshIcon)
+        updateIcon(Passive, properties, mIconThemePath);
+    if (parts & RefreshAttentionIcon)
+        updateIcon(NeedsAttention, properties, mIconThemePath);
+
+    if (parts & RefreshToolTip)
+    {
+        const QString toolTipTitle = qdbus_cast<ToolTip>(properties.value(QStringLiteral("ToolTip"))).title;
+        if (!toolTipTitle.isEmpty())
+            setToolTip(toolTipTitle);
+        else
+        {
+            const QString title = properties.value(QStringLiteral("Title")).toString();
+            if (!title.isEmpty())
+                setToolTip(title);
+        }
+    }
+}
+
+void StatusNotifierButton::updateIcon(Status status, const QVariantMap &properties, const QString& themePath)
 {
     QString nameProperty, pixmapProperty;
     if (status == Active)
@@ -162,133 +306,74 @@ void StatusNotifierButton::refetchIcon(Status status, const QString& themePath)
         pixmapProperty = QLatin1String("IconPixmap");
     }
 
-    interface->propertyGetAsync(nameProperty, [this, status, pixmapProperty, themePath] (QString iconName) {
-        if (!iconName.isEmpty())
+    QIcon nextIcon;
+    const QString iconName = properties.value(nameProperty).toString();
+    if (!iconName.isEmpty())
+    {
+        nextIcon = QIcon::fromTheme(iconName);
+        if (nextIcon.isNull() && !themePath.isEmpty())
         {
-            QIcon nextIcon = QIcon::fromTheme(iconName);
-            if (nextIcon.isNull())
-            {
-                QDir themeDir(themePath);
-                if (themeDir.exists())
-                {
-                    bool hasExtension = iconName.endsWith(QStringLiteral(".png"))
-                                        || iconName.endsWith(QStringLiteral(".svg"))
-                                        || iconName.endsWith(QStringLiteral(".xpm"));
-                    if (hasExtension)
-                    { // extension is included
-                        if (themeDir.exists(iconName))
-                            nextIcon.addFile(themeDir.filePath(iconName));
-                    }
-                    else
-                    {
-                        if (themeDir.exists(iconName + QStringLiteral(".png")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".png")));
-                        if (themeDir.exists(iconName + QStringLiteral(".svg")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".svg")));
-                        if (themeDir.exists(iconName + QStringLiteral(".xpm")))
-                            nextIcon.addFile(themeDir.filePath(iconName + QStringLiteral(".xpm")));
-                    }
-
-                    if (themeDir.cd(QStringLiteral("hicolor")) || (themeDir.cd(QStringLiteral("icons")) && themeDir.cd(QStringLiteral("hicolor"))))
-                    {
-                        const QStringList sizes = themeDir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-                        for (const QString &dir : sizes)
-                        {
-                            const QStringList dirs = QDir(themeDir.filePath(dir)).entryList(QDir::AllDirs | QDir::NoDotAndDotDot);
-                            for (const QString &innerDir : dirs)
-                            {
-                                QString path = themeDir.absolutePath() + QLatin1Char('/') + dir + QLatin1Char('/') + innerDir + QLatin1Char('/') + iconName;
-                                if (hasExtension)
-                                { // extension is included
-                                    if (QFile::exists(path))
-                                        nextIcon.addFile(path);
-                                }
-                                else
-                                {
-                                    if (QFile::exists(path + QStringLiteral(".png")))
-                                        nextIcon.addFile(path + QStringLiteral(".png"));
-                                    if (QFile::exists(path + QStringLiteral(".svg")))
-                                        nextIcon.addFile(path + QStringLiteral(".svg"));
-                                    if (QFile::exists(path + QStringLiteral(".xpm")))
-                                        nextIcon.addFile(path + QStringLiteral(".xpm"));
-                                }
-                            }
-                        }
-                    }
-                }
-            }
+            QStringList files;
+            // the icon is set upon the indexed() if the themePath isn't indexed yet
+            if (!mIconThemePathIndex->find(themePath, iconName, files))
+                return;
+            for (const QString &file : qAsConst(files))
+                nextIcon.addFile(file);
+        }
+        mPixmapCache[status] = PixmapCache{};
+    }
+    else
+    {
+        IconPixmapList iconPixmaps = qdbus_cast<IconPixmapList>(properties.value(pixmapProperty));
+        if (iconPixmaps.empty())
+            return;
+
+        // the pixmaps are converted only if their data differ from the ones
+        // of the previous update (animations send the same frames repeatedly)
+        PixmapCache & cache = mPixmapCache[status];
+        QVector<uint> hashes;
+        hashes.reserve(iconPixmaps.size());
+        for (const IconPixmap &iconPixmap : qAsConst(iconPixmaps))
+            hashes << qHash(iconPixmap.bytes, (uint(iconPixmap.width) << 16) ^ uint(iconPixmap.height));
+        if (hashes == cache.hashes)
+            return;
+
+        QHash<uint, QPixmap> pixmaps;
+        for (int i = 0, i_e = iconPixmaps.size(); i < i_e; ++i)
+        {
+            IconPixmap &iconPixmap = iconPixmaps[i];
+            const qsizetype pixels = qsizetype(iconPixmap.width) * iconPixmap.height;
+            if (iconPixmap.bytes.isNull() || 0 >= pixels || iconPixmap.bytes.size() < pixels * 4)
+                continue;
 
-            switch (status)
+            QPixmap pixmap = cache.pixmaps.value(hashes.at(i));
+            if (pixmap.isNull())
             {
-                case Active:
-                    mOverlayIcon = nextIcon;
-                    break;
-                case NeedsAttention:
-                    mAttentionIcon = nextIcon;
-                    break;
-                case Passive:
-                    mIcon = nextIcon;
-                    break;
+                uchar *data = reinterpret_cast<uchar*>(iconPixmap.bytes.data());
+                swapArgbByteOrder(data, pixels);
+                pixmap = QPixmap::fromImage(QImage(data, iconPixmap.width, iconPixmap.height, QImage::Format_ARGB32));
             }
-
-            resetIcon();
-        }
-        else
-        {
-            interface->propertyGetAsync(pixmapProperty, [this, status, pixmapProperty] (IconPixmapList iconPixmaps) {
-                if (iconPixmaps.empty())
-                    return;
-
-                QIcon nextIcon;
-
-                for (IconPixmap iconPixmap: iconPixmaps)
-                {
-                    if (!iconPixmap.bytes.isNull())
-                    {
-                        QImage image((uchar*) iconPixmap.bytes.data(), iconPixmap.width,
-                                     iconPixmap.height, QImage::Format_ARGB32);
-
-                        const uchar *end = image.constBits() + image.sizeInBytes();
-                        uchar *dest = reinterpret_cast<uchar*>(iconPixmap.bytes.data());
-                        for (const uchar *src = image.constBits(); src < end; src += 4, dest += 4)
-                            qToUnaligned(qToBigEndian<quint32>(qFromUnaligned<quint32>(src)), dest);
-
-                        nextIcon.addPixmap(QPixmap::fromImage(image));
-                    }
-                }
-
-                switch (status)
-                {
-                    case Active:
-                        mOverlayIcon = nextIcon;
-                        break;
-                    case NeedsAttention:
-                        mAttentionIcon = nextIcon;
-                        break;
-                    case Passive:
-                        mIcon = nextIcon;
-                        break;
-                }
-
-                resetIcon();
-            });
+            nextIcon.addPixmap(pixmap);
+            pixmaps.insert(hashes.at(i), pixmap);
         }
-    });
-}
+        cache.hashes = std::move(hashes);
+        cache.pixmaps = std::move(pixmaps);
+    }
 
-void StatusNotifierButton::newToolTip()
-{
-    interface->propertyGetAsync(QLatin1String("ToolTip"), [this] (ToolTip tooltip) {
-        QString toolTipTitle = tooltip.title;
-        if (!toolTipTitle.isEmpty())
-            setToolTip(toolTipTitle);
-        else
-            interface->propertyGetAsync(QLatin1String("Title"), [this] (QString title) {
-                // we should get here only in case the ToolTip.title was empty
-                if (!title.isEmpty())
-                    setToolTip(title);
-            });
-    });
+    switch (status)
+    {
+        case Active:
+            mOverlayIcon = nextIcon;
+            break;
+        case NeedsAttention:
+            mAttentionIcon = nextIcon;
+            break;
+        case Passive:
+            mIcon = nextIcon;
+            break;
+    }
+
+    resetIcon();
 }
 
 void StatusNotifierButton::newStatus(QString status)
@@ -324,6 +409,7 @@ void StatusNotifierButton::mouseReleaseEvent(QMouseEvent *event)
         interface->SecondaryActivate(QCursor::pos().x(), QCursor::pos().y());
     else if (Qt::RightButton == event->button())
     {
+        prefetchMenu(); // if not hovered before
         if (mMenu)
         {
             mPlugin->willShowWindow(mMenu);
@@ -335,6 +421,37 @@ void StatusNotifierButton::mouseReleaseEvent(QMouseEvent *event)
     QToolButton::mouseReleaseEvent(event);
 }
 
+void StatusNotifierButton::enterEvent(QEvent *event)
+{
+    // the user is probably going to open the menu
+    prefetchMenu();
+    QToolButton::enterEvent(event);
+}
+
+void StatusNotifierButton::prefetchMenu()
+{
+    if (mMenuPath.isEmpty())
+        return;
+
+    if (!mMenuImporter)
+    {
+        mMenuImporter = new MenuImporter{interface->service(), mMenuPath, this};
+        mMenu = mMenuImporter->menu();
+        mMenu->setObjectName(QLatin1String("StatusNotifierMenu"));
+    } else if (mMenuFetchedRevision == mMenuRevision)
+    {
+        return; // the cached layout is current
+    }
+    mMenuFetchedRevision = mMenuRevision;
+    mMenuImporter->updateMenu();
+}
+
+void StatusNotifierButton::menuLayoutUpdated(uint revision, int parentId)
+{
+    Q_UNUSED(parentId) // the importer refreshes just the changed (sub)menu itself
+    mMenuRevision = revision;
+}
+
 void StatusNotifierButton::wheelEvent(QWheelEvent *event)
 {
     QPoint angleDelta = event->angleDelta();
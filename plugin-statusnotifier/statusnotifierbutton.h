@@ -37,16 +37,22 @@
 #include <QWheelEvent>
 #include <QMenu>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPixmap>
+#include <QVector>
 
 class ILXQtPanelPlugin;
+class IconThemePathIndex;
 class SniAsync;
+class DBusMenuImporter;
 
 class StatusNotifierButton : public QToolButton
 {
     Q_OBJECT
 
 public:
-    StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin,  QWidget *parent = nullptr);
+    StatusNotifierButton(QString service, QString objectPath, ILXQtPanelPlugin* plugin, IconThemePathIndex *iconThemePathIndex, QWidget *parent = nullptr);
     ~StatusNotifierButton();
 
     enum Status
@@ -59,6 +65,20 @@ public:
     }
     bool hasAttention() const;
     void setAutoHide(bool autoHide, int minutes = 5, bool forcedVisible = false);
+    //! The bounds and the default of the setMaxIconRate()
+    enum
+    {
+        MIN_ICON_RATE = 1,
+        MAX_ICON_RATE = 60,
+        DEFAULT_ICON_RATE = 10
+    };
+    /*! \brief Limit the icon updates of the item to \param rate per second
+     */
+    void setMaxIconRate(int rate);
+    /*! \brief The share of the (GUI thread) CPU time spent on the updates
+     * and painting of the item, averaged over the last few seconds
+     */
+    qreal cpuLoad() const;
 
 signals:
     void titleFound(const QString &title);
@@ -71,27 +91,74 @@ public slots:
     void newToolTip();
     void newStatus(QString status);
 
+private slots:
+    void menuLayoutUpdated(uint revision, int parentId);
+
 private:
+    enum RefreshPart
+    {
+        RefreshIcon = 0x1,
+        RefreshOverlayIcon = 0x2,
+        RefreshAttentionIcon = 0x4,
+        RefreshToolTip = 0x8,
+        RefreshIcons = RefreshIcon | RefreshOverlayIcon | RefreshAttentionIcon, //!< the rate limited parts
+        RefreshAll = RefreshIcons | RefreshToolTip
+    };
+
     void onNeedingAttention();
+    void prefetchMenu();
+    void requestRefresh(int parts);
+    int refreshDelay() const;
+    int iconRefreshDelay() const;
+    void refresh();
+    void addCpuCost(qint64 nsecs);
+    void applyProperties(const QVariantMap &properties, int parts);
 
     SniAsync *interface;
     QMenu *mMenu;
+    DBusMenuImporter *mMenuImporter; //!< created upon the first hovering
+    QString mMenuPath;
+    uint mMenuRevision; //!< the last LayoutUpdated revision
+    uint mMenuFetchedRevision; //!< the revision of the last prefetch
     Status mStatus;
 
     QIcon mIcon, mOverlayIcon, mAttentionIcon, mFallbackIcon;
 
+    struct PixmapCache
+    {
+        QVector<uint> hashes; //!< of the IconPixmap data, in the order of the last update
+        QHash<uint, QPixmap> pixmaps; //!< converted pixmaps by their data hash
+    };
+    PixmapCache mPixmapCache[NeedsAttention + 1]; //!< per Status
+
     ILXQtPanelPlugin* mPlugin;
+    IconThemePathIndex *mIconThemePathIndex; //!< shared by the buttons of the widget
 
     QString mTitle;
+    QString mIconThemePath;
     bool mAutoHide;
     QTimer mHideTimer;
 
+    // coalescing of the change signals, at most one GetAll is in flight
+    QTimer mRefreshTimer;
+    int mRefreshNeeded; //!< parts signalled as changed since the last request
+    bool mRefreshing;
+    bool mInitialized; //!< the properties fetched only at the start are known
+
+    // icon update rate limiting
+    int mMaxIconRate;
+    QElapsedTimer mLastIconRefresh;
+    qreal mCpuLoad; //!< as of the mCpuLoadTime
+    QElapsedTimer mCpuLoadTime;
+
 protected:
+    void paintEvent(QPaintEvent *event) override;
+    void enterEvent(QEvent *event) override;
     void contextMenuEvent(QContextMenuEvent * event);
     void mouseReleaseEvent(QMouseEvent *event);
     void wheelEvent(QWheelEvent *event);
 
-    void refetchIcon(Status status, const QString& themePath);
+    void updateIcon(Status status, const QVariantMap &properties, const QString& themePath);
     void resetIcon();
 };
 
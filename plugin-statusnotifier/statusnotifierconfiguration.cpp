@@ -25,8 +25,26 @@
 
 #include "statusnotifierconfiguration.h"
 #include "ui_statusnotifierconfiguration.h"
+#include "statusnotifierwidget.h"
 #include <QPushButton>
 #include <QComboBox>
+#include <QSpinBox>
+#include <QStyledItemDelegate>
+
+namespace
+{
+    // the loads are kept as numbers (in percents) to be sorted numerically
+    class CpuLoadDelegate : public QStyledItemDelegate
+    {
+    public:
+        using QStyledItemDelegate::QStyledItemDelegate;
+
+        QString displayText(const QVariant &value, const QLocale &locale) const override
+        {
+            return QStringLiteral("%1 %").arg(locale.toString(value.toReal(), 'f', 1));
+        }
+    };
+}
 
 StatusNotifierConfiguration::StatusNotifierConfiguration(PluginSettings *settings, QWidget *parent):
     LXQtPanelPluginConfigDialog(settings, parent),
@@ -35,6 +53,7 @@ StatusNotifierConfiguration::StatusNotifierConfiguration(PluginSettings *setting
     setAttribute(Qt::WA_DeleteOnClose);
     setObjectName(QStringLiteral("StatusNotifierConfigurationWindow"));
     ui->setupUi(this);
+    ui->maxIconRateSB->setRange(StatusNotifierButton::MIN_ICON_RATE, StatusNotifierButton::MAX_ICON_RATE);
 
     if (QPushButton *closeBtn = ui->buttons->button(QDialogButtonBox::Close))
         closeBtn->setDefault(true);
@@ -43,10 +62,12 @@ StatusNotifierConfiguration::StatusNotifierConfiguration(PluginSettings *setting
     ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     ui->tableWidget->horizontalHeader()->setSectionsClickable(false);
     ui->tableWidget->sortByColumn(0, Qt::AscendingOrder);
+    ui->tableWidget->setItemDelegateForColumn(2, new CpuLoadDelegate(ui->tableWidget));
 
     loadSettings();
 
     connect(ui->attentionSB, &QAbstractSpinBox::editingFinished, this, &StatusNotifierConfiguration::saveSettings);
+    connect(ui->maxIconRateSB, &QAbstractSpinBox::editingFinished, this, &StatusNotifierConfiguration::saveSettings);
 }
 
 StatusNotifierConfiguration::~StatusNotifierConfiguration()
@@ -57,15 +78,27 @@ StatusNotifierConfiguration::~StatusNotifierConfiguration()
 void StatusNotifierConfiguration::loadSettings()
 {
     ui->attentionSB->setValue(settings().value(QStringLiteral("attentionPeriod"), 5).toInt());
+    ui->maxIconRateSB->setValue(settings().value(QStringLiteral("maxIconRate"), StatusNotifierButton::DEFAULT_ICON_RATE).toInt());
     mAutoHideList = settings().value(QStringLiteral("autoHideList")).toStringList();
     mHideList = settings().value(QStringLiteral("hideList")).toStringList();
+    mIconRates = StatusNotifierWidget::readIconRates(&settings());
 }
 
 void StatusNotifierConfiguration::saveSettings()
 {
     settings().setValue(QStringLiteral("attentionPeriod"), ui->attentionSB->value());
+    settings().setValue(QStringLiteral("maxIconRate"), ui->maxIconRateSB->value());
     settings().setValue(QStringLiteral("autoHideList"), mAutoHideList);
     settings().setValue(QStringLiteral("hideList"), mHideList);
+    QList<QMap<QString, QVariant>> iconRates;
+    for (auto i = mIconRates.cbegin(), i_e = mIconRates.cend(); i != i_e; ++i)
+    {
+        QMap<QString, QVariant> entry;
+        entry[QStringLiteral("item")] = i.key();
+        entry[QStringLiteral("rate")] = i.value();
+        iconRates << entry;
+    }
+    settings().setArray(QStringLiteral("iconRates"), iconRates);
 }
 
 void StatusNotifierConfiguration::addItems(const QStringList &items)
@@ -107,6 +140,24 @@ void StatusNotifierConfiguration::addItems(const QStringList &items)
             saveSettings();
         });
         ui->tableWidget->setCellWidget(index, 1, cb);
+        // third column
+        widgetItem = new QTableWidgetItem;
+        widgetItem->setFlags(widgetItem->flags() & ~Qt::ItemIsEditable & ~Qt::ItemIsSelectable);
+        widgetItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        ui->tableWidget->setItem(index, 2, widgetItem);
+        // fourth column
+        QSpinBox *sb = new QSpinBox();
+        sb->setRange(0, StatusNotifierButton::MAX_ICON_RATE);
+        sb->setSpecialValueText(tr("Default"));
+        sb->setValue(mIconRates.value(item, 0));
+        connect(sb, QOverload<int>::of(&QSpinBox::valueChanged), this, [this, item] (int rate) {
+            if (rate == 0)
+                mIconRates.remove(item);
+            else
+                mIconRates.insert(item, rate);
+            saveSettings();
+        });
+        ui->tableWidget->setCellWidget(index, 3, sb);
         ++ index;
     }
     ui->tableWidget->setSortingEnabled(true);
@@ -114,6 +165,21 @@ void StatusNotifierConfiguration::addItems(const QStringList &items)
     ui->tableWidget->setCurrentCell(0, 1);
 }
 
+void StatusNotifierConfiguration::setCpuLoads(const QHash<QString, qreal> &loads)
+{
+    // the rows must not be reordered while walking them
+    ui->tableWidget->setSortingEnabled(false);
+    for (int i = 0; i < ui->tableWidget->rowCount(); ++i)
+    {
+        QTableWidgetItem *titleItem = ui->tableWidget->item(i, 0);
+        QTableWidgetItem *loadItem = ui->tableWidget->item(i, 2);
+        if (titleItem && loadItem)
+            loadItem->setData(Qt::DisplayRole, 100 * loads.value(titleItem->text()));
+    }
+    ui->tableWidget->setSortingEnabled(true);
+    ui->tableWidget->horizontalHeader()->setSortIndicatorShown(false);
+}
+
 void StatusNotifierConfiguration::dialogButtonsAction(QAbstractButton *btn)
 {
     LXQtPanelPluginConfigDialog::dialogButtonsAction(btn);
@@ -137,6 +203,15 @@ void StatusNotifierConfiguration::dialogButtonsAction(QAbstractButton *btn)
                     cb->blockSignals(false);
                 }
             }
+            if (auto sb = qobject_cast<QSpinBox*>(ui->tableWidget->cellWidget(i, 3)))
+            {
+                if (QTableWidgetItem *widgetItem = ui->tableWidget->item(i, 0))
+                {
+                    sb->blockSignals(true);
+                    sb->setValue(mIconRates.value(widgetItem->text(), 0));
+                    sb->blockSignals(false);
+                }
+            }
         }
     }
 }
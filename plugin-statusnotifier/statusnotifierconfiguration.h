@@ -29,6 +29,8 @@
 #include "../panel/lxqtpanelpluginconfigdialog.h"
 #include "../panel/pluginsettings.h"
 
+#include <QHash>
+
 namespace Ui {
     class StatusNotifierConfiguration;
 }
@@ -42,12 +44,16 @@ public:
     ~StatusNotifierConfiguration();
 
     void addItems(const QStringList &items);
+    /*! \brief Show the CPU loads of the items (by their titles)
+     */
+    void setCpuLoads(const QHash<QString, qreal> &loads);
 
 private:
     Ui::StatusNotifierConfiguration *ui;
 
     QStringList mAutoHideList;
     QStringList mHideList;
+    QHash<QString, int> mIconRates; //!< the max. icon rate overrides, by the item titles
 
     void loadSettings();
 
@@ -29,6 +29,9 @@
 #include "statusnotifierwatcher.h"
 #include <QDebug>
 #include <QDBusConnectionInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <algorithm>
 
 StatusNotifierWatcher::StatusNotifierWatcher(QObject *parent) : QObject(parent)
 {
@@ -66,27 +69,71 @@ StatusNotifierWatcher::~StatusNotifierWatcher()
     QDBusConnection::sessionBus().unregisterService(QStringLiteral("org.kde.StatusNotifierWatcher"));
 }
 
-void StatusNotifierWatcher::RegisterStatusNotifierItem(const QString &serviceOrPath)
+QString StatusNotifierWatcher::notifierItemId(const QString &serviceOrPath, QString &service) const
 {
-    QString service = serviceOrPath;
+    service = serviceOrPath;
     QString path = QStringLiteral("/StatusNotifierItem");
 
-    // workaround for sni-qt
+    // workaround for sni-qt, also used by connections serving several items
     if (service.startsWith(QLatin1Char('/')))
     {
         path = service;
         service = message().service();
     }
 
-    QString notifierItemId = service + path;
+    return service + path;
+}
+
+void StatusNotifierWatcher::RegisterStatusNotifierItem(const QString &serviceOrPath)
+{
+    QString service;
+    const QString notifierItemId = this->notifierItemId(serviceOrPath, service);
+    if (mServices.contains(notifierItemId) || mPending.contains(notifierItemId))
+        return;
+
+    // confirm the service asynchronously, not to block on a (busy) bus daemon;
+    // watching it already drops the item if it vanishes meanwhile
+    mPending << notifierItemId;
+    mWatcher->addWatchedService(service);
+    QDBusPendingCall call = QDBusConnection::sessionBus().interface()->asyncCall(QStringLiteral("NameHasOwner"), service);
+    connect(new QDBusPendingCallWatcher{call, this}, &QDBusPendingCallWatcher::finished, this,
+            [this, service, notifierItemId] (QDBusPendingCallWatcher * call)
+            {
+                call->deleteLater();
+                if (!mPending.removeOne(notifierItemId))
+                    return; // unregistered meanwhile
+
+                QDBusPendingReply<bool> reply = *call;
+                if (reply.isError())
+                    qDebug() << "StatusNotifier: unable to confirm service" << service << reply.error();
+                if (!reply.isError() && reply.value())
+                {
+                    mServices << notifierItemId;
+                    emit StatusNotifierItemRegistered(notifierItemId);
+                } else
+                {
+                    unwatchUnused(service);
+                }
+            });
+}
+
+void StatusNotifierWatcher::UnregisterStatusNotifierItem(const QString &serviceOrPath)
+{
+    QString service;
+    const QString notifierItemId = this->notifierItemId(serviceOrPath, service);
+
+    // only the owner may drop its items; those registered by a well-known
+    // name are dropped with the name anyway
+    if (service != message().service())
+        return;
 
-    if (QDBusConnection::sessionBus().interface()->isServiceRegistered(service).value()
-        && !mServices.contains(notifierItemId))
+    if (!mPending.removeOne(notifierItemId))
     {
-        mServices << notifierItemId;
-        mWatcher->addWatchedService(service);
-        emit StatusNotifierItemRegistered(notifierItemId);
+        if (!mServices.removeOne(notifierItemId))
+            return;
+        emit StatusNotifierItemUnregistered(notifierItemId);
     }
+    unwatchUnused(service);
 }
 
 void StatusNotifierWatcher::RegisterStatusNotifierHost(const QString &service)
@@ -111,6 +158,11 @@ void StatusNotifierWatcher::serviceUnregistered(const QString &service)
     }
 
     QString match = service + QLatin1Char('/');
+    // not confirmed yet -> nobody knows about them
+    mPending.erase(std::remove_if(mPending.begin(), mPending.end(), [&match] (const QString &item) {
+                return item.startsWith(match);
+            }), mPending.end());
+
     QStringList::Iterator it = mServices.begin();
     while (it != mServices.end())
     {
@@ -124,3 +176,15 @@ void StatusNotifierWatcher::serviceUnregistered(const QString &service)
             ++it;
     }
 }
+
+void StatusNotifierWatcher::unwatchUnused(const QString &service)
+{
+    const QString match = service + QLatin1Char('/');
+    const auto used = [&match] (const QString &item) { return item.startsWith(match); };
+    if (!mHosts.contains(service)
+        && std::none_of(mServices.cbegin(), mServices.cend(), used)
+        && std::none_of(mPending.cbegin(), mPending.cend(), used))
+    {
+        mWatcher->removeWatchedService(service);
+    }
+}
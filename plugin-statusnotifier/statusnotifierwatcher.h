@@ -60,12 +60,22 @@ signals:
 
 public slots:
     Q_SCRIPTABLE void RegisterStatusNotifierItem(const QString &serviceOrPath);
+    /*! \brief Drops a single item of a connection serving several ones
+     *
+     * Items registered by path share their connection's service, whose
+     * unregistration only tells about all of them at once.
+     */
+    Q_SCRIPTABLE void UnregisterStatusNotifierItem(const QString &serviceOrPath);
     Q_SCRIPTABLE void RegisterStatusNotifierHost(const QString &service);
 
     void serviceUnregistered(const QString &service);
 
 private:
+    QString notifierItemId(const QString &serviceOrPath, QString &service) const;
+    void unwatchUnused(const QString &service);
+
     QStringList mServices;
+    QStringList mPending; //!< items registered, but their service not confirmed yet
     QStringList mHosts;
     QDBusServiceWatcher *mWatcher;
 };
@@ -28,6 +28,7 @@
 
 #include "statusnotifierwidget.h"
 #include "statusnotifierproxy.h"
+#include "iconthemepathindex.h"
 #include "../panel/pluginsettings.h"
 #include "../panel/ilxqtpanelplugin.h"
 
@@ -35,10 +36,14 @@ StatusNotifierWidget::StatusNotifierWidget(ILXQtPanelPlugin *plugin, QWidget *pa
     QWidget(parent),
     mPlugin(plugin),
     mAttentionPeriod(5),
+    mMaxIconRate(StatusNotifierButton::DEFAULT_ICON_RATE),
     mForceVisible(false)
 {
     setLayout(new LXQt::GridLayout(this));
 
+    // the index of the IconThemePaths is shared by all the buttons
+    mIconThemePathIndex = new IconThemePathIndex(this);
+
     // The button that shows all hidden items:
     mShowBtn = new QToolButton(this);
     mShowBtn->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
@@ -106,7 +111,8 @@ void StatusNotifierWidget::itemAdded(QString serviceAndPath)
     int slash = serviceAndPath.indexOf(QLatin1Char('/'));
     QString serv = serviceAndPath.left(slash);
     QString path = serviceAndPath.mid(slash);
-    StatusNotifierButton *button = new StatusNotifierButton(serv, path, mPlugin, this);
+    StatusNotifierButton *button = new StatusNotifierButton(serv, path, mPlugin, mIconThemePathIndex, this);
+    button->setMaxIconRate(mMaxIconRate);
 
     mServices.insert(serviceAndPath, button);
     layout()->addWidget(button);
@@ -115,6 +121,7 @@ void StatusNotifierWidget::itemAdded(QString serviceAndPath)
     // show/hide the added item appropriately and show mShowBtn if needed
     connect(button, &StatusNotifierButton::titleFound, this, [this, button] (const QString &title) {
         mItemTitles << title;
+        button->setMaxIconRate(mIconRates.value(title, mMaxIconRate));
         if (mAutoHideList.contains(title))
         {
             if (!mForceVisible)
@@ -199,12 +206,15 @@ void StatusNotifierWidget::settingsChanged()
     mAttentionPeriod = mPlugin->settings()->value(QStringLiteral("attentionPeriod"), 5).toInt();
     mAutoHideList = mPlugin->settings()->value(QStringLiteral("autoHideList")).toStringList();
     mHideList = mPlugin->settings()->value(QStringLiteral("hideList")).toStringList();
+    mMaxIconRate = mPlugin->settings()->value(QStringLiteral("maxIconRate"), StatusNotifierButton::DEFAULT_ICON_RATE).toInt();
+    mIconRates = readIconRates(mPlugin->settings());
 
     // show/hide items as well as showBtn appropriately
     const auto allButtons = findChildren<StatusNotifierButton *>(QString(), Qt::FindDirectChildrenOnly);
     bool showBtn = false;
     for (const auto &btn : allButtons)
     {
+        btn->setMaxIconRate(mIconRates.value(btn->title(), mMaxIconRate));
         if (mAutoHideList.contains(btn->title()))
         {
             btn->setAutoHide(true, mAttentionPeriod);
@@ -237,6 +247,20 @@ void StatusNotifierWidget::settingsChanged()
         mShowBtn->show();
 }
 
+QHash<QString, int> StatusNotifierWidget::readIconRates(PluginSettings *settings)
+{
+    QHash<QString, int> rates;
+    const auto list = settings->readArray(QStringLiteral("iconRates"));
+    for (const auto &entry : list)
+    {
+        const QString item = entry.value(QStringLiteral("item")).toString();
+        const int rate = entry.value(QStringLiteral("rate")).toInt();
+        if (!item.isEmpty() && rate > 0)
+            rates.insert(item, rate);
+    }
+    return rates;
+}
+
 void StatusNotifierWidget::realign()
 {
     LXQt::GridLayout *layout = qobject_cast<LXQt::GridLayout*>(this->layout());
@@ -263,3 +287,11 @@ QStringList StatusNotifierWidget::itemTitles() const
     names.removeDuplicates();
     return names;
 }
+
+QHash<QString, qreal> StatusNotifierWidget::itemCpuLoads() const
+{
+    QHash<QString, qreal> loads;
+    for (const auto &btn : qAsConst(mServices))
+        loads[btn->title()] += btn->cpuLoad();
+    return loads;
+}
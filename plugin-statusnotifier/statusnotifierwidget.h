@@ -35,6 +35,8 @@
 #include "statusnotifierbutton.h"
 
 class StatusNotifierProxy;
+class PluginSettings;
+class IconThemePathIndex;
 
 class StatusNotifierWidget : public QWidget
 {
@@ -45,7 +47,13 @@ public:
     ~StatusNotifierWidget() = default;
 
     void settingsChanged();
+    /*! \brief Reads the icon rate overrides of the items (by their titles) from the \param settings
+     */
+    static QHash<QString, int> readIconRates(PluginSettings *settings);
     QStringList itemTitles() const;
+    /*! \brief The CPU load of the items, by their titles
+     */
+    QHash<QString, qreal> itemCpuLoads() const;
 
 signals:
 
@@ -61,6 +69,7 @@ protected:
 
 private:
     ILXQtPanelPlugin *mPlugin;
+    IconThemePathIndex *mIconThemePathIndex; //!< shared by the buttons
 
     QTimer mHideTimer;
 
@@ -71,5 +80,7 @@ private:
     QStringList mHideList;
     QToolButton *mShowBtn;
     int mAttentionPeriod;
+    int mMaxIconRate; //!< the default for the items without an override
+    QHash<QString, int> mIconRates; //!< the max. icon rate overrides, by the item titles
     bool mForceVisible;
 };
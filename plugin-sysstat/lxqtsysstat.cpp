@@ -27,6 +27,7 @@
 
 #include "lxqtsysstat.h"
 #include "lxqtsysstatutils.h"
+#include "lxqtsysstatcores.h"
 
 #include <SysStat/CpuStat>
 #include <SysStat/MemStat>
@@ -39,6 +40,8 @@
 #include <QVBoxLayout>
 #include <QCoreApplication>
 
+#include <algorithm>
+
 LXQtSysStat::LXQtSysStat(const ILXQtPanelPluginStartupInfo &startupInfo):
     QObject(),
     ILXQtPanelPlugin(startupInfo),
@@ -113,11 +116,14 @@ LXQtSysStatContent::LXQtSysStatContent(ILXQtPanelPlugin *plugin, QWidget *parent
     QWidget(parent),
     mPlugin(plugin),
     mStat(nullptr),
+    mCoreStat(nullptr),
     mUpdateInterval(0),
     mMinimalSize(0),
     mTitleFontPixelHeight(0),
     mUseThemeColours(true),
-    mHistoryOffset(0)
+    mGraph(NoGraph),
+    mHistoryOffset(0),
+    mHistoryOutdated(true)
 {
     setObjectName(QStringLiteral("SysStat_Graph"));
 }
@@ -141,7 +147,10 @@ void LXQtSysStatContent::SETNAME##Colour(QColor value) \
 { \
     mThemeColours.GETNAME##Colour = value; \
     if (mUseThemeColours) \
+    { \
         mColours.GETNAME##Colour = mThemeColours.GETNAME##Colour; \
+        mHistoryOutdated = true; \
+    } \
 }
 
 #undef QSS_NET_COLOUR
@@ -154,6 +163,7 @@ void LXQtSysStatContent::SETNAME##Colour(QColor value) \
     { \
         mColours.GETNAME##Colour = mThemeColours.GETNAME##Colour; \
         mixNetColours(); \
+        mHistoryOutdated = true; \
     } \
 }
 
@@ -284,6 +294,23 @@ void LXQtSysStatContent::updateSettings(const PluginSettings *settings)
     bool needFullReset       = needTimerRestarting || minimalSizeChanged || logScaleStepsChanged || logarithmicScaleChanged;
 
 
+    if (mDataType == QLatin1String("CPU") && mDataSource == QLatin1String("cores"))
+        mGraph = CoreHeatmapGraph;
+    else if (mDataType == QLatin1String("CPU"))
+        mGraph = mUseFrequency ? CpuFrequencyGraph : CpuGraph;
+    else if (mDataType == QLatin1String("Memory"))
+        mGraph = mDataSource == QLatin1String("memory") ? MemoryGraph : SwapGraph;
+    else if (mDataType == QLatin1String("Network"))
+        mGraph = NetworkGraph;
+    else
+        mGraph = NoGraph;
+
+    // the samples of another graph mean something else
+    if (needReconnecting)
+        mHistory.clear();
+    // colours or scale may have changed
+    mHistoryOutdated = true;
+
     if (mStat)
     {
         if (needTimerRestarting)
@@ -293,7 +320,9 @@ void LXQtSysStatContent::updateSettings(const PluginSettings *settings)
             mStat->disconnect(this);
     }
 
-    if (dataTypeChanged)
+    // the heatmap samples all cores itself, instead of a SysStat::BaseStat
+    const bool heatmap = mGraph == CoreHeatmapGraph;
+    if (dataTypeChanged || (needReconnecting && (heatmap || !mStat)))
     {
         if (mStat)
         {
@@ -301,7 +330,7 @@ void LXQtSysStatContent::updateSettings(const PluginSettings *settings)
             mStat = nullptr;
         }
 
-        if (mDataType == QLatin1String("CPU"))
+        if (mDataType == QLatin1String("CPU") && !heatmap)
             mStat = new SysStat::CpuStat(this);
         else if (mDataType == QLatin1String("Memory"))
             mStat = new SysStat::MemStat(this);
@@ -348,6 +377,22 @@ void LXQtSysStatContent::updateSettings(const PluginSettings *settings)
             mStat->setUpdateInterval(static_cast<int>(mUpdateInterval * 1000.0));
     }
 
+    if (heatmap)
+    {
+        if (!mCoreStat)
+        {
+            mCoreStat = new PluginSysStat::CoreStat(this);
+            connect(mCoreStat, &PluginSysStat::CoreStat::update, this, &LXQtSysStatContent::coresUpdate);
+        }
+        if (needTimerRestarting)
+            mCoreStat->setUpdateInterval(static_cast<int>(mUpdateInterval * 1000.0));
+    }
+    else if (mCoreStat)
+    {
+        mCoreStat->deleteLater();
+        mCoreStat = nullptr;
+    }
+
     if (needFullReset)
         reset();
     else
@@ -364,15 +409,10 @@ void LXQtSysStatContent::reset()
     setMinimumSize(mPlugin->panel()->isHorizontal() ? mMinimalSize : 2,
                    mPlugin->panel()->isHorizontal() ? 2 : mMinimalSize);
 
-    if (width() > mHistoryImage.width())
-    {
-        QImage newImage{width(), 100, QImage::Format_ARGB32};
-        newImage.fill(Qt::transparent);
-        QPainter p{&newImage};
-        p.drawImage(mHistoryImage.rect(), mHistoryImage, mHistoryImage.rect());
-        mHistoryImage = newImage;
-        update();
-    }
+    // keep the samples of the widest graph so far, to show them again if it grows back
+    mHistory.setCapacity(qMax(mHistory.capacity(), width()));
+    mHistoryOutdated = true;
+    update();
 }
 
 template <typename T>
@@ -381,64 +421,251 @@ T clamp(const T &value, const T &min, const T &max)
     return qMin(qMax(value, min), max);
 }
 
-// QPainter.drawLine with pen set to Qt::transparent doesn't clear anything
-void LXQtSysStatContent::clearLine()
+void LXQtSysStatContent::netScale(unsigned received, unsigned transmitted, qreal &min_value, qreal &max_value) const
 {
-    QRgb bg = QColor(Qt::transparent).rgba();
-    for (int i = 0; i < 100; ++i)
-        reinterpret_cast<QRgb*>(mHistoryImage.scanLine(i))[mHistoryOffset] = bg;
+    min_value = qMin(qMax(static_cast<qreal>(qMin(received, transmitted)) / mNetRealMaximumSpeed, static_cast<qreal>(0.0)), static_cast<qreal>(1.0));
+    max_value = qMin(qMax(static_cast<qreal>(qMax(received, transmitted)) / mNetRealMaximumSpeed, static_cast<qreal>(0.0)), static_cast<qreal>(1.0));
+    if (mLogarithmicScale)
+    {
+        min_value = qLn(min_value * (mLogScaleMax - 1.0) + 1.0) / qLn(2.0) / static_cast<qreal>(mLogScaleSteps);
+        max_value = qLn(max_value * (mLogScaleMax - 1.0) + 1.0) / qLn(2.0) / static_cast<qreal>(mLogScaleSteps);
+    }
 }
 
-void LXQtSysStatContent::cpuLoadFrequencyUpdate(float user, float nice, float system, float other, float frequencyRate, uint)
+int LXQtSysStatContent::segmentColours(QRgb *colours) const
 {
-    int y_system = static_cast<int>(system * 100.0 * frequencyRate);
-    int y_user   = static_cast<int>(user   * 100.0 * frequencyRate);
-    int y_nice   = static_cast<int>(nice   * 100.0 * frequencyRate);
-    int y_other  = static_cast<int>(other  * 100.0 * frequencyRate);
-    int y_freq   = static_cast<int>(         100.0 * frequencyRate);
+    switch (mGraph)
+    {
+    case CpuGraph:
+    case CpuFrequencyGraph:
+        colours[0] = mColours.cpuSystemColour.rgba();
+        colours[1] = mColours.cpuUserColour.rgba();
+        colours[2] = mColours.cpuNiceColour.rgba();
+        colours[3] = mColours.cpuOtherColour.rgba();
+        colours[4] = mColours.frequencyColour.rgba();
+        return mGraph == CpuGraph ? 4 : 5;
+
+    case MemoryGraph:
+        colours[0] = mColours.memAppsColour.rgba();
+        colours[1] = mColours.memBuffersColour.rgba();
+        colours[2] = mColours.memCachedColour.rgba();
+        return 3;
+
+    case SwapGraph:
+        colours[0] = mColours.swapUsedColour.rgba();
+        return 1;
+
+    case NetworkGraph:
+        colours[0] = mNetBothColour.rgba();
+        colours[1] = mColours.netReceivedColour.rgba();
+        colours[2] = mColours.netTransmittedColour.rgba();
+        return 3;
+
+    case CoreHeatmapGraph:
+    case NoGraph:
+        break;
+    }
+    return 0;
+}
 
-    toolTipInfo(tr("system: %1%<br>user: %2%<br>nice: %3%<br>other: %4%<br>freq: %5%", "CPU tooltip information")
-            .arg(y_system).arg(y_user).arg(y_nice).arg(y_other).arg(y_freq));
+// the top of each segment of the stacked graph, in pixels
+void LXQtSysStatContent::sampleLevels(int age, int height, int *levels) const
+{
+    const auto level = [height] (qreal value) { return clamp(static_cast<int>(value * height), 0, height); };
+    const auto value = [this, age] (int series) { return static_cast<qreal>(mHistory.value(series, age)); };
+
+    switch (mGraph)
+    {
+    case CpuGraph:
+    case CpuFrequencyGraph:
+    {
+        // user, nice, system, other and the frequency rate
+        const qreal rate = mGraph == CpuFrequencyGraph ? value(4) : 1.0;
+        levels[0] = level(value(2) * rate);
+        levels[1] = level((value(2) + value(0)) * rate);
+        levels[2] = level((value(2) + value(0) + value(1)) * rate);
+        levels[3] = level((value(2) + value(0) + value(1) + value(3)) * rate);
+        levels[4] = qMax(level(rate), levels[3]);
+        break;
+    }
 
-    y_system = clamp(y_system, 0, 99);
-    y_user   = clamp(y_user + y_system, 0, 99);
-    y_nice   = clamp(y_nice + y_user  , 0, 99);
-    y_other  = clamp(y_other, 0, 99);
-    y_freq   = clamp(y_freq, 0, 99);
+    case MemoryGraph:
+        levels[0] = level(value(0));
+        levels[1] = level(value(0) + value(1));
+        levels[2] = level(value(0) + value(1) + value(2));
+        break;
 
-    clearLine();
-    QPainter painter(&mHistoryImage);
-    if (y_system != 0)
+    case SwapGraph:
+        levels[0] = level(value(0));
+        break;
+
+    case NetworkGraph:
     {
-        painter.setPen(mColours.cpuSystemColour);
-        painter.drawLine(mHistoryOffset, y_system, mHistoryOffset, 0);
+        // what both directions have in common, then the rest of the larger one
+        const unsigned received = static_cast<unsigned>(value(0));
+        const unsigned transmitted = static_cast<unsigned>(value(1));
+        qreal min_value, max_value;
+        netScale(received, transmitted, min_value, max_value);
+        levels[0] = level(min_value);
+        const int top = clamp(level(max_value) + levels[0], 0, height);
+        levels[1] = received > transmitted ? top : levels[0];
+        levels[2] = top;
+        break;
+    }
+
+    case CoreHeatmapGraph:
+    case NoGraph:
+        break;
     }
-    if (y_user != y_system)
+}
+
+int LXQtSysStatContent::graphHeight() const
+{
+    return qMax(height() - (mTitleLabel.isEmpty() ? 0 : mTitleFontPixelHeight), 1);
+}
+
+void LXQtSysStatContent::renderHistory()
+{
+    mHistoryOutdated = false;
+
+    const int w = qMax(width(), 1);
+    const int h = graphHeight();
+    if (mHistoryImage.size() != QSize(w, h))
+        mHistoryImage = QImage(w, h, QImage::Format_ARGB32);
+    mHistoryOffset = 0;
+
+    if (mGraph == CoreHeatmapGraph)
     {
-        painter.setPen(mColours.cpuUserColour);
-        painter.drawLine(mHistoryOffset, y_user, mHistoryOffset, y_system);
+        updateHeatmapColours();
+        renderHeatmap(0, w, w - 1);
+        return;
     }
-    if (y_nice != y_user)
+
+    QRgb colours[MaxSegments];
+    const int segments = segmentColours(colours);
+
+    // the newest sample goes to the rightmost column
+    QVector<int> levels[MaxSegments];
+    for (int k = 0; k < segments; ++k)
+        levels[k].fill(0, w);
+    int sample[MaxSegments];
+    for (int x = qMax(w - mHistory.count(), 0); x < w; ++x)
     {
-        painter.setPen(mColours.cpuNiceColour);
-        painter.drawLine(mHistoryOffset, y_nice, mHistoryOffset, y_user);
+        sampleLevels(w - 1 - x, h, sample);
+        for (int k = 0; k < segments; ++k)
+            levels[k][x] = sample[k];
     }
-    if (y_other != y_nice)
+
+    const int *columnLevels[MaxSegments];
+    for (int k = 0; k < segments; ++k)
+        columnLevels[k] = levels[k].constData();
+    PluginSysStat::fillColumns(mHistoryImage.bits(), mHistoryImage.bytesPerLine(), w, h, columnLevels, colours, segments);
+}
+
+// transparent when idle, the user colour at half load, the system one at full load
+void LXQtSysStatContent::updateHeatmapColours()
+{
+    const QColor cold = mColours.cpuUserColour;
+    const QColor hot = mColours.cpuSystemColour;
+    mHeatmapColours.resize(256);
+    for (int i = 0; i < 256; ++i)
     {
-        painter.setPen(mColours.cpuOtherColour);
-        painter.drawLine(mHistoryOffset, y_other, mHistoryOffset, y_nice);
+        if (i < 128)
+        {
+            mHeatmapColours[i] = qRgba(cold.red(), cold.green(), cold.blue(), cold.alpha() * i / 128);
+        }
+        else
+        {
+            const int t = i - 128;
+            mHeatmapColours[i] = qRgba(cold.red()   + (hot.red()   - cold.red())   * t / 127,
+                                       cold.green() + (hot.green() - cold.green()) * t / 127,
+                                       cold.blue()  + (hot.blue()  - cold.blue())  * t / 127,
+                                       cold.alpha() + (hot.alpha() - cold.alpha()) * t / 127);
+        }
     }
-    if (y_freq != y_other)
+}
+
+/* Writes the heatmap into the columns [column, column + columns) of the image,
+ * the first of them shows the sample of newestAge, the following ones the newer ones.
+ * A row shows the hottest of its cores, the first core is on the top.
+ */
+void LXQtSysStatContent::renderHeatmap(int column, int columns, int newestAge)
+{
+    const int cores = mHistory.series();
+    const int h = mHistoryImage.height();
+    for (int y = 0; y < h; ++y)
     {
-        painter.setPen(mColours.frequencyColour);
-        painter.drawLine(mHistoryOffset, y_freq, mHistoryOffset, y_other);
+        QRgb *line = reinterpret_cast<QRgb *>(mHistoryImage.scanLine(y)) + column;
+        if (cores == 0)
+        {
+            std::fill(line, line + columns, 0);
+            continue;
+        }
+
+        // the image is bottom up
+        const int row = h - 1 - y;
+        const int first = row * cores / h;
+        const int last = qMax((row + 1) * cores / h, first + 1);
+        for (int x = 0; x < columns; ++x)
+        {
+            const int age = newestAge - x;
+            if (age >= mHistory.count())
+            {
+                line[x] = 0;
+                continue;
+            }
+            float load = 0;
+            for (int core = first; core < last; ++core)
+                load = qMax(load, mHistory.value(core, age));
+            line[x] = mHeatmapColours.at(clamp(static_cast<int>(load * 255.0f), 0, 255));
+        }
     }
+}
 
-    mHistoryOffset = (mHistoryOffset + 1) % mHistoryImage.width();
+void LXQtSysStatContent::appendSample(const float *sample, int series)
+{
+    // e.g. a CPU core went offline, the history starts over
+    if (series != mHistory.series())
+        mHistoryOutdated = true;
+    mHistory.append(sample, series);
+
+    // render just the new column, unless all of them are going to be
+    if (!mHistoryOutdated && mHistoryImage.size() == QSize(qMax(width(), 1), graphHeight()))
+    {
+        if (mGraph == CoreHeatmapGraph)
+            renderHeatmap(mHistoryOffset, 1, 0);
+        else
+        {
+            QRgb colours[MaxSegments];
+            const int segments = segmentColours(colours);
+            int levels[MaxSegments];
+            sampleLevels(0, mHistoryImage.height(), levels);
+            const int *columnLevels[MaxSegments];
+            for (int k = 0; k < segments; ++k)
+                columnLevels[k] = &levels[k];
+            PluginSysStat::fillColumns(mHistoryImage.bits() + mHistoryOffset * sizeof(QRgb), mHistoryImage.bytesPerLine(), 1, mHistoryImage.height(), columnLevels, colours, segments);
+        }
+
+        mHistoryOffset = (mHistoryOffset + 1) % mHistoryImage.width();
+    }
 
     update(0, mTitleFontPixelHeight, width(), height() - mTitleFontPixelHeight);
 }
 
+void LXQtSysStatContent::cpuLoadFrequencyUpdate(float user, float nice, float system, float other, float frequencyRate, uint)
+{
+    int y_system = static_cast<int>(system * 100.0 * frequencyRate);
+    int y_user   = static_cast<int>(user   * 100.0 * frequencyRate);
+    int y_nice   = static_cast<int>(nice   * 100.0 * frequencyRate);
+    int y_other  = static_cast<int>(other  * 100.0 * frequencyRate);
+    int y_freq   = static_cast<int>(         100.0 * frequencyRate);
+
+    toolTipInfo(tr("system: %1%<br>user: %2%<br>nice: %3%<br>other: %4%<br>freq: %5%", "CPU tooltip information")
+            .arg(y_system).arg(y_user).arg(y_nice).arg(y_other).arg(y_freq));
+
+    appendSample({user, nice, system, other, frequencyRate});
+}
+
 void LXQtSysStatContent::cpuLoadUpdate(float user, float nice, float system, float other)
 {
     int y_system = static_cast<int>(system * 100.0);
@@ -449,37 +676,7 @@ void LXQtSysStatContent::cpuLoadUpdate(float user, float nice, float system, flo
     toolTipInfo(tr("system: %1%<br>user: %2%<br>nice: %3%<br>other: %4%<br>freq: n/a", "CPU tooltip information")
             .arg(y_system).arg(y_user).arg(y_nice).arg(y_other));
 
-    y_system = clamp(y_system, 0, 99);
-    y_user   = clamp(y_user + y_system, 0, 99);
-    y_nice   = clamp(y_nice + y_user, 0, 99);
-    y_other  = clamp(y_other + y_nice, 0, 99);
-
-    clearLine();
-    QPainter painter(&mHistoryImage);
-    if (y_system != 0)
-    {
-        painter.setPen(mColours.cpuSystemColour);
-        painter.drawLine(mHistoryOffset, y_system, mHistoryOffset, 0);
-    }
-    if (y_user != y_system)
-    {
-        painter.setPen(mColours.cpuUserColour);
-        painter.drawLine(mHistoryOffset, y_user, mHistoryOffset, y_system);
-    }
-    if (y_nice != y_user)
-    {
-        painter.setPen(mColours.cpuNiceColour);
-        painter.drawLine(mHistoryOffset, y_nice, mHistoryOffset, y_user);
-    }
-    if (y_other != y_nice)
-    {
-        painter.setPen(mColours.cpuOtherColour);
-        painter.drawLine(mHistoryOffset, y_other, mHistoryOffset, y_nice);
-    }
-
-    mHistoryOffset = (mHistoryOffset + 1) % mHistoryImage.width();
-
-    update(0, mTitleFontPixelHeight, width(), height() - mTitleFontPixelHeight);
+    appendSample({user, nice, system, other});
 }
 
 void LXQtSysStatContent::memoryUpdate(float apps, float buffers, float cached)
@@ -491,31 +688,7 @@ void LXQtSysStatContent::memoryUpdate(float apps, float buffers, float cached)
     toolTipInfo(tr("apps: %1%<br>buffers: %2%<br>cached: %3%", "Memory tooltip information")
         .arg(y_apps).arg(y_buffers).arg(y_cached));
 
-    y_apps    = clamp(y_apps, 0, 99);
-    y_buffers = clamp(y_buffers + y_apps, 0, 99);
-    y_cached  = clamp(y_cached + y_buffers, 0, 99);
-
-    clearLine();
-    QPainter painter(&mHistoryImage);
-    if (y_apps != 0)
-    {
-        painter.setPen(mColours.memAppsColour);
-        painter.drawLine(mHistoryOffset, y_apps, mHistoryOffset, 0);
-    }
-    if (y_buffers != y_apps)
-    {
-        painter.setPen(mColours.memBuffersColour);
-        painter.drawLine(mHistoryOffset, y_buffers, mHistoryOffset, y_apps);
-    }
-    if (y_cached != y_buffers)
-    {
-        painter.setPen(mColours.memCachedColour);
-        painter.drawLine(mHistoryOffset, y_cached, mHistoryOffset, y_buffers);
-    }
-
-    mHistoryOffset = (mHistoryOffset + 1) % mHistoryImage.width();
-
-    update(0, mTitleFontPixelHeight, width(), height() - mTitleFontPixelHeight);
+    appendSample({apps, buffers, cached});
 }
 
 void LXQtSysStatContent::swapUpdate(float used)
@@ -524,55 +697,52 @@ void LXQtSysStatContent::swapUpdate(float used)
 
     toolTipInfo(tr("used: %1%", "Swap tooltip information").arg(y_used));
 
-    y_used = clamp(y_used, 0, 99);
-
-    clearLine();
-    QPainter painter(&mHistoryImage);
-    if (y_used != 0)
-    {
-        painter.setPen(mColours.swapUsedColour);
-        painter.drawLine(mHistoryOffset, y_used, mHistoryOffset, 0);
-    }
-
-    mHistoryOffset = (mHistoryOffset + 1) % mHistoryImage.width();
-
-    update(0, mTitleFontPixelHeight, width(), height() - mTitleFontPixelHeight);
+    appendSample({used});
 }
 
 void LXQtSysStatContent::networkUpdate(unsigned received, unsigned transmitted)
 {
-    qreal min_value = qMin(qMax(static_cast<qreal>(qMin(received, transmitted)) / mNetRealMaximumSpeed, static_cast<qreal>(0.0)), static_cast<qreal>(1.0));
-    qreal max_value = qMin(qMax(static_cast<qreal>(qMax(received, transmitted)) / mNetRealMaximumSpeed, static_cast<qreal>(0.0)), static_cast<qreal>(1.0));
-    if (mLogarithmicScale)
-    {
-        min_value = qLn(min_value * (mLogScaleMax - 1.0) + 1.0) / qLn(2.0) / static_cast<qreal>(mLogScaleSteps);
-        max_value = qLn(max_value * (mLogScaleMax - 1.0) + 1.0) / qLn(2.0) / static_cast<qreal>(mLogScaleSteps);
-    }
+    qreal min_value, max_value;
+    netScale(received, transmitted, min_value, max_value);
 
     int y_min_value = static_cast<int>(min_value * 100.0);
     int y_max_value = static_cast<int>(max_value * 100.0);
 
     toolTipInfo(tr("min: %1%<br>max: %2%", "Network tooltip information").arg(y_min_value).arg(y_max_value));
 
-    y_min_value = clamp(y_min_value, 0, 99);
-    y_max_value = clamp(y_max_value + y_min_value, 0, 99);
+    // the raw speeds, to be scaled again if the scale changes
+    appendSample({static_cast<float>(received), static_cast<float>(transmitted)});
+}
+
+void LXQtSysStatContent::coresUpdate(const QVector<float> &loads, const QVector<int> &ids)
+{
+    if (loads.isEmpty())
+        return;
 
-    clearLine();
-    QPainter painter(&mHistoryImage);
-    if (y_min_value != 0)
+    // the rows of the history belong to other cores now
+    if (ids != mCoreIds)
     {
-        painter.setPen(mNetBothColour);
-        painter.drawLine(mHistoryOffset, y_min_value, mHistoryOffset, 0);
+        mCoreIds = ids;
+        mHistory.clear();
+        mHistoryOutdated = true;
     }
-    if (y_max_value != y_min_value)
+
+    int hottest = 0;
+    float sum = 0;
+    for (int core = 0; core < loads.count(); ++core)
     {
-        painter.setPen((received > transmitted) ? mColours.netReceivedColour : mColours.netTransmittedColour);
-        painter.drawLine(mHistoryOffset, y_max_value, mHistoryOffset, y_min_value);
+        sum += loads.at(core);
+        if (loads.at(core) > loads.at(hottest))
+            hottest = core;
     }
 
-    mHistoryOffset = (mHistoryOffset + 1) % mHistoryImage.width();
+    toolTipInfo(tr("cores: %1<br>average: %2%<br>hottest: cpu%3 %4%", "CPU cores tooltip information")
+            .arg(loads.count())
+            .arg(static_cast<int>(sum / loads.count() * 100.0))
+            .arg(ids.at(hottest))
+            .arg(static_cast<int>(loads.at(hottest) * 100.0)));
 
-    update(0, mTitleFontPixelHeight, width(), height() - mTitleFontPixelHeight);
+    appendSample(loads.constData(), loads.count());
 }
 
 void LXQtSysStatContent::paintEvent(QPaintEvent *event)
@@ -600,11 +770,15 @@ void LXQtSysStatContent::paintEvent(QPaintEvent *event)
     if (graphHeight < 1)
         graphHeight = 1;
 
+    if (mHistoryOutdated || mHistoryImage.size() != QSize(qMax(width(), 1), this->graphHeight()))
+        renderHistory();
+
     p.scale(1.0, -1.0);
 
-    p.drawImage(QRect(0, -height(), width() - mHistoryOffset, graphHeight), mHistoryImage, QRect(mHistoryOffset, 0, width() - mHistoryOffset, 100));
+    const int historyHeight = mHistoryImage.height();
+    p.drawImage(QRect(0, -height(), width() - mHistoryOffset, graphHeight), mHistoryImage, QRect(mHistoryOffset, 0, width() - mHistoryOffset, historyHeight));
     if (mHistoryOffset)
-        p.drawImage(QRect(width() - mHistoryOffset, -height(), mHistoryOffset, graphHeight), mHistoryImage, QRect(0, 0, mHistoryOffset, 100));
+        p.drawImage(QRect(width() - mHistoryOffset, -height(), mHistoryOffset, graphHeight), mHistoryImage, QRect(0, 0, mHistoryOffset, historyHeight));
 
     p.resetTransform();
 
@@ -30,6 +30,7 @@
 
 #include "../panel/ilxqtpanelplugin.h"
 #include "lxqtsysstatconfiguration.h"
+#include "lxqtsysstathistory.h"
 
 #include <QLabel>
 
@@ -42,6 +43,10 @@ namespace SysStat {
     class BaseStat;
 }
 
+namespace PluginSysStat {
+    class CoreStat;
+}
+
 class LXQtSysStat : public QObject, public ILXQtPanelPlugin
 {
     Q_OBJECT
@@ -142,6 +147,7 @@ protected slots:
     void memoryUpdate(float apps, float buffers, float cached);
     void swapUpdate(float used);
     void networkUpdate(unsigned received, unsigned transmitted);
+    void coresUpdate(const QVector<float> &loads, const QVector<int> &ids);
 
 private:
     void toolTipInfo(QString const & tooltip);
@@ -150,6 +156,8 @@ private:
     ILXQtPanelPlugin *mPlugin;
 
     SysStat::BaseStat *mStat;
+    PluginSysStat::CoreStat *mCoreStat;
+    QVector<int> mCoreIds; //!< of the cores in the history (the online ones)
 
     typedef struct ColourPalette
     {
@@ -201,11 +209,35 @@ private:
     QColor mNetBothColour;
 
 
+    enum Graph
+    {
+        NoGraph,
+        CpuGraph,
+        CpuFrequencyGraph,
+        MemoryGraph,
+        SwapGraph,
+        NetworkGraph,
+        CoreHeatmapGraph
+    };
+    enum { MaxSegments = 5 };
+
+    Graph mGraph;
+    PluginSysStat::History mHistory;
     int mHistoryOffset;
-    QImage mHistoryImage;
-
-
-    void clearLine();
+    QImage mHistoryImage; //!< the history rendered bottom up, a column per sample
+    bool mHistoryOutdated;
+    QVector<QRgb> mHeatmapColours; //!< by the load scaled to 0..255
+
+
+    void netScale(unsigned received, unsigned transmitted, qreal &min_value, qreal &max_value) const;
+    void appendSample(std::initializer_list<float> sample) { appendSample(sample.begin(), static_cast<int>(sample.size())); }
+    void appendSample(const float *sample, int series);
+    int segmentColours(QRgb *colours) const;
+    void sampleLevels(int age, int height, int *levels) const;
+    int graphHeight() const;
+    void renderHistory();
+    void updateHeatmapColours();
+    void renderHeatmap(int column, int columns, int newestAge);
 
     void mixNetColours();
     void updateTitleFontPixelHeight();
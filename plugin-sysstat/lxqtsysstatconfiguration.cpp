@@ -76,6 +76,7 @@ namespace
         static_cast<void>(QT_TRANSLATE_NOOP("LXQtSysStatConfiguration", "cpu21"));
         static_cast<void>(QT_TRANSLATE_NOOP("LXQtSysStatConfiguration", "cpu22"));
         static_cast<void>(QT_TRANSLATE_NOOP("LXQtSysStatConfiguration", "cpu23"));
+        static_cast<void>(QT_TRANSLATE_NOOP("LXQtSysStatConfiguration", "cores"));
         static_cast<void>(QT_TRANSLATE_NOOP("LXQtSysStatConfiguration", "memory"));
         static_cast<void>(QT_TRANSLATE_NOOP("LXQtSysStatConfiguration", "swap"));
         static_cast<void>(t);//avoid unused variable warning
@@ -199,6 +200,9 @@ void LXQtSysStatConfiguration::on_typeCOB_currentIndexChanged(int index)
     const auto sources = mStat->sources();
     for (auto const & s : sources)
         ui->sourceCOB->addItem(tr(s.toStdString().c_str()), s);
+    // all the cores as a heatmap, sampled by the plugin itself
+    if (index == 0)
+        ui->sourceCOB->addItem(tr("cores"), QStringLiteral("cores"));
     ui->sourceCOB->blockSignals(false);
     ui->sourceCOB->setCurrentIndex(0);
 }
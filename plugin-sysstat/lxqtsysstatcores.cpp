@@ -0,0 +1,205 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqtsysstatcores.h"
+
+#include <QFile>
+#include <QTimer>
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace PluginSysStat
+{
+
+CoreStat::CoreStat(QObject *parent) :
+    QObject(parent),
+    mTimer(new QTimer(this))
+{
+    connect(mTimer, &QTimer::timeout, this, &CoreStat::sample);
+}
+
+CoreStat::~CoreStat() = default;
+
+void CoreStat::setUpdateInterval(int msec)
+{
+    // the first loads are relative to now
+    if (!mTimer->isActive() && readCounters())
+    {
+        mPrevIds = mIds;
+        mPrevBusy = mBusy;
+        mPrevTotal = mTotal;
+    }
+    mTimer->start(msec);
+}
+
+void CoreStat::stopUpdating()
+{
+    mTimer->stop();
+}
+
+void CoreStat::sample()
+{
+    if (!readCounters())
+        return;
+
+    const int cores = mBusy.count();
+    if (mIds != mPrevIds)
+    {
+        // a core went online/offline, the previous counters are matched by the ids
+        QVector<quint64> prevBusy(cores), prevTotal(cores);
+        for (int i = 0; i < cores; ++i)
+        {
+            const int prev = mPrevIds.indexOf(mIds.at(i));
+            // a core that appeared starts idle
+            prevBusy[i] = prev < 0 ? mBusy.at(i) : mPrevBusy.at(prev);
+            prevTotal[i] = prev < 0 ? mTotal.at(i) : mPrevTotal.at(prev);
+        }
+        mPrevBusy.swap(prevBusy);
+        mPrevTotal.swap(prevTotal);
+    }
+    mLoads.resize(cores);
+    coreLoads(mBusy.constData(), mTotal.constData(), mPrevBusy.constData(), mPrevTotal.constData(), mLoads.data(), cores);
+
+    mBusy.swap(mPrevBusy);
+    mTotal.swap(mPrevTotal);
+    mPrevIds = mIds;
+
+    emit update(mLoads, mIds);
+}
+
+bool CoreStat::readCounters()
+{
+    QFile file(QStringLiteral("/proc/stat"));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return false;
+
+    // the buffer is kept, /proc/stat has a few kB per 64 cores
+    qint64 size = 0;
+    for (;;)
+    {
+        if (size == mBuffer.size())
+            mBuffer.resize(qMax(mBuffer.size() * 2, 16384));
+        const qint64 read = file.read(mBuffer.data() + size, mBuffer.size() - size);
+        if (read <= 0)
+            break;
+        size += read;
+    }
+
+    int cores = 0;
+    const char *p = mBuffer.constData();
+    const char *end = p + size;
+    while (p < end)
+    {
+        const char *eol = static_cast<const char *>(memchr(p, '\n', end - p));
+        if (!eol)
+            eol = end;
+
+        if (eol - p > 3 && strncmp(p, "cpu", 3) == 0)
+        {
+            p += 3;
+            // the "cpu" line is the aggregate
+            if (*p >= '0' && *p <= '9')
+            {
+                int core = 0;
+                while (p < eol && *p >= '0' && *p <= '9')
+                    core = core * 10 + (*p++ - '0');
+
+                // user nice system idle iowait irq softirq steal
+                quint64 fields[8] = {};
+                for (quint64 &field : fields)
+                {
+                    while (p < eol && *p == ' ')
+                        ++p;
+                    while (p < eol && *p >= '0' && *p <= '9')
+                        field = field * 10 + (*p++ - '0');
+                }
+
+                if (cores >= mBusy.count())
+                {
+                    mIds.resize(cores + 1);
+                    mBusy.resize(cores + 1);
+                    mTotal.resize(cores + 1);
+                }
+                const quint64 idle = fields[3] + fields[4];
+                mIds[cores] = core;
+                mBusy[cores] = fields[0] + fields[1] + fields[2] + fields[5] + fields[6] + fields[7];
+                mTotal[cores] = mBusy[cores] + idle;
+                ++cores;
+            }
+        }
+        else if (cores)
+        {
+            // the cpu lines come first
+            break;
+        }
+
+        p = eol + 1;
+    }
+
+    if (cores == 0)
+        return false;
+    // a core went away
+    mIds.resize(cores);
+    mBusy.resize(cores);
+    mTotal.resize(cores);
+    return true;
+}
+
+void coreLoads(const quint64 *busy, const quint64 *total, const quint64 *prevBusy, const quint64 *prevTotal, float *loads, int cores)
+{
+    int i = 0;
+#if defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const auto deltas = [] (const quint64 *now, const quint64 *prev) {
+        const __m128i low  = _mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(now)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev)));
+        const __m128i high = _mm_sub_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i *>(now + 2)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i *>(prev + 2)));
+        // the deltas of an update interval fit into 31 bits, keep the low halves
+        const __m128 packed = _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(2, 0, 2, 0));
+        return _mm_cvtepi32_ps(_mm_castps_si128(packed));
+    };
+    for (; i + 4 <= cores; i += 4)
+    {
+        const __m128 busyDelta = deltas(busy + i, prevBusy + i);
+        const __m128 totalDelta = _mm_max_ps(deltas(total + i, prevTotal + i), one);
+        _mm_storeu_ps(loads + i, _mm_min_ps(_mm_max_ps(_mm_div_ps(busyDelta, totalDelta), zero), one));
+    }
+#endif
+    for (; i < cores; ++i)
+    {
+        const float busyDelta = static_cast<qint32>(busy[i] - prevBusy[i]);
+        const float totalDelta = qMax(static_cast<float>(static_cast<qint32>(total[i] - prevTotal[i])), 1.0f);
+        loads[i] = qBound(0.0f, busyDelta / totalDelta, 1.0f);
+    }
+}
+
+}
@@ -0,0 +1,83 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTSYSSTATCORES_H
+#define LXQTSYSSTATCORES_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QVector>
+
+class QTimer;
+
+namespace PluginSysStat
+{
+
+/*! \brief Load of every CPU core
+ *
+ * The counters of all the cores are read from /proc/stat in one pass, which
+ * SysStat::CpuStat can't do, as it monitors a single source. Only the online
+ * cores are listed there, so their ids can be sparse (e.g. cpu0, cpu1, cpu3).
+ */
+class CoreStat : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CoreStat(QObject *parent = nullptr);
+    ~CoreStat();
+
+    void setUpdateInterval(int msec);
+    void stopUpdating();
+
+signals:
+    //! \param loads the busy time fraction of every (online) core since the last update,
+    //! \param ids the ids of those cores
+    void update(const QVector<float> &loads, const QVector<int> &ids);
+
+private slots:
+    void sample();
+
+private:
+    bool readCounters();
+
+    QTimer *mTimer;
+    QByteArray mBuffer;
+    QVector<int> mIds; //!< of the cores, in the order of the counters
+    QVector<int> mPrevIds;
+    QVector<quint64> mBusy;
+    QVector<quint64> mTotal;
+    QVector<quint64> mPrevBusy;
+    QVector<quint64> mPrevTotal;
+    QVector<float> mLoads;
+};
+
+/*! \brief Computes \param loads = (busy - prevBusy) / (total - prevTotal)
+ * clamped to [0, 1] for \param cores cores, four of them at once by SSE2
+ */
+void coreLoads(const quint64 *busy, const quint64 *total, const quint64 *prevBusy, const quint64 *prevTotal, float *loads, int cores);
+
+}
+
+#endif // LXQTSYSSTATCORES_H
@@ -0,0 +1,175 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqtsysstathistory.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SYSSTAT_X86
+#endif
+
+
+namespace PluginSysStat
+{
+
+History::History() :
+    mCapacity(0),
+    mCount(0),
+    mHead(0)
+{
+}
+
+void History::clear(int series)
+{
+    mSeries = QVector<QVector<float>>(series, QVector<float>(mCapacity));
+    mCount = 0;
+    mHead = 0;
+}
+
+void History::setCapacity(int capacity)
+{
+    if (capacity == mCapacity)
+        return;
+
+    // move the kept samples to the beginning, oldest first
+    const int kept = qMin(mCount, capacity);
+    for (QVector<float> &values : mSeries)
+    {
+        QVector<float> resized(capacity);
+        for (int i = 0; i < kept; ++i)
+            resized[i] = values[(mHead - kept + i + mCapacity) % mCapacity];
+        values = resized;
+    }
+
+    mCapacity = capacity;
+    mCount = kept;
+    mHead = capacity ? kept % capacity : 0;
+}
+
+void History::append(const float *sample, int series)
+{
+    if (mCapacity == 0)
+        return;
+
+    if (series != mSeries.count())
+        clear(series);
+
+    for (int s = 0; s < series; ++s)
+        mSeries[s][mHead] = sample[s];
+
+    mHead = (mHead + 1) % mCapacity;
+    if (mCount < mCapacity)
+        ++mCount;
+}
+
+float History::value(int series, int age) const
+{
+    return mSeries.at(series).at((mHead - 1 - age + mCapacity) % mCapacity);
+}
+
+
+namespace
+{
+
+void fillRowScalar(QRgb *row, int y, int from, int width, const int * const *levels, const QRgb *colours, int segments)
+{
+    for (int x = from; x < width; ++x)
+    {
+        QRgb colour = 0;
+        for (int k = segments - 1; k >= 0; --k)
+            if (y < levels[k][x])
+                colour = colours[k];
+        row[x] = colour;
+    }
+}
+
+#if defined(SYSSTAT_X86)
+__attribute__((target("sse2")))
+void fillRowSse2(QRgb *row, int y, int width, const int * const *levels, const QRgb *colours, int segments)
+{
+    const __m128i row_y = _mm_set1_epi32(y);
+    int x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        __m128i colour = _mm_setzero_si128();
+        for (int k = segments - 1; k >= 0; --k)
+        {
+            const __m128i below = _mm_cmpgt_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(levels[k] + x)), row_y);
+            colour = _mm_or_si128(_mm_and_si128(below, _mm_set1_epi32(static_cast<int>(colours[k]))), _mm_andnot_si128(below, colour));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(row + x), colour);
+    }
+    fillRowScalar(row, y, x, width, levels, colours, segments);
+}
+
+__attribute__((target("avx2")))
+void fillRowAvx2(QRgb *row, int y, int width, const int * const *levels, const QRgb *colours, int segments)
+{
+    const __m256i row_y = _mm256_set1_epi32(y);
+    int x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m256i colour = _mm256_setzero_si256();
+        for (int k = segments - 1; k >= 0; --k)
+        {
+            const __m256i below = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(levels[k] + x)), row_y);
+            colour = _mm256_blendv_epi8(colour, _mm256_set1_epi32(static_cast<int>(colours[k])), below);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(row + x), colour);
+    }
+    fillRowScalar(row, y, x, width, levels, colours, segments);
+}
+#endif
+
+void fillRowGeneric(QRgb *row, int y, int width, const int * const *levels, const QRgb *colours, int segments)
+{
+    fillRowScalar(row, y, 0, width, levels, colours, segments);
+}
+
+using FillRowFunction = void (*)(QRgb *, int, int, const int * const *, const QRgb *, int);
+
+FillRowFunction selectFillRow()
+{
+#if defined(SYSSTAT_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return fillRowAvx2;
+    if (__builtin_cpu_supports("sse2"))
+        return fillRowSse2;
+#endif
+    return fillRowGeneric;
+}
+
+}
+
+void fillColumns(uchar *bits, qsizetype bytesPerLine, int width, int height, const int * const *levels, const QRgb *colours, int segments)
+{
+    static const FillRowFunction fillRow = selectFillRow();
+
+    for (int y = 0; y < height; ++y)
+        fillRow(reinterpret_cast<QRgb *>(bits + y * bytesPerLine), y, width, levels, colours, segments);
+}
+
+}
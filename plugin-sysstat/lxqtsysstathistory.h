@@ -0,0 +1,80 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTSYSSTATHISTORY_H
+#define LXQTSYSSTATHISTORY_H
+
+#include <QRgb>
+#include <QVector>
+
+#include <initializer_list>
+
+namespace PluginSysStat
+{
+
+/*! \brief Ring buffer of the samples shown by the graph
+ *
+ * Each series (e.g. user/nice/system CPU load) is kept in its own array of
+ * floats, so the history doesn't depend on the size of the graph and can be
+ * rendered again at any time.
+ */
+class History
+{
+public:
+    History();
+
+    //! Drops all samples, the following ones have \param series values each
+    void clear(int series = 0);
+    //! Keeps up to \param capacity newest samples
+    void setCapacity(int capacity);
+
+    int capacity() const { return mCapacity; }
+    int count() const { return mCount; }
+    int series() const { return mSeries.count(); }
+
+    void append(std::initializer_list<float> sample) { append(sample.begin(), static_cast<int>(sample.size())); }
+    void append(const float *sample, int series);
+    //! \return the value of \param series, \param age is 0 for the newest sample
+    float value(int series, int age) const;
+
+private:
+    QVector<QVector<float>> mSeries;
+    int mCapacity;
+    int mCount;
+    int mHead; //!< the slot of the next sample
+};
+
+/*! \brief Fills the columns of a 32-bit image bottom up
+ *
+ * In column x, rows [levels[k - 1][x], levels[k][x]) get \param colours[k]
+ * (rows below levels[0][x] get colours[0]), rows above the last level are
+ * transparent. The levels of a column have to be non-decreasing. The rows
+ * are filled several columns at once, by SSE2/AVX2 where available.
+ */
+void fillColumns(uchar *bits, qsizetype bytesPerLine, int width, int height, const int * const *levels, const QRgb *colours, int segments);
+
+}
+
+#endif // LXQTSYSSTATHISTORY_H
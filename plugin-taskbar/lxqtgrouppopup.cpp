@@ -29,14 +29,75 @@
  * END_COMMON_COPYRIGHT_HEADER */
 
 #include "lxqtgrouppopup.h"
+#include "lxqttaskthumbnailer.h"
 #include <QEnterEvent>
 #include <QDrag>
 #include <QMimeData>
 #include <QLayout>
 #include <QPainter>
 #include <QStyleOption>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QSortFilterProxyModel>
+#include <QContextMenuEvent>
+#include <QCoreApplication>
+#include <QScreen>
 #include <QDebug>
 
+/************************************************
+
+ ************************************************/
+int LXQtGroupPopupModel::rowCount(const QModelIndex & parent) const
+{
+    return parent.isValid() ? 0 : mButtons.count();
+}
+
+QVariant LXQtGroupPopupModel::data(const QModelIndex & index, int role) const
+{
+    if (!index.isValid() || index.row() >= mButtons.count())
+        return QVariant{};
+
+    LXQtTaskButton const * const button = mButtons.at(index.row());
+    switch (role)
+    {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        // the tooltip holds the title without the mnemonic escaping
+        return button->toolTip();
+    case Qt::DecorationRole:
+        return button->icon();
+    case Qt::FontRole:
+        if (button->isChecked() || button->hasUrgencyHint())
+        {
+            QFont font = button->font();
+            font.setBold(true);
+            return font;
+        }
+        break;
+    }
+    return QVariant{};
+}
+
+void LXQtGroupPopupModel::setButtons(const QList<LXQtTaskButton *> & buttons)
+{
+    beginResetModel();
+    mButtons = buttons;
+    endResetModel();
+}
+
+void LXQtGroupPopupModel::buttonChanged(LXQtTaskButton * button)
+{
+    const int row = mButtons.indexOf(button);
+    if (row >= 0)
+        emit dataChanged(index(row), index(row));
+}
+
+LXQtTaskButton * LXQtGroupPopupModel::button(const QModelIndex & index) const
+{
+    return index.isValid() && index.row() < mButtons.count() ? mButtons.at(index.row()) : nullptr;
+}
+
 /************************************************
     this class is just a container of window buttons
     the main purpose is showing window buttons in
@@ -45,7 +106,15 @@
  ************************************************/
 LXQtGroupPopup::LXQtGroupPopup(LXQtTaskGroup *group):
     QFrame(group),
-    mGroup(group)
+    mGroup(group),
+    mButtons(new QWidget(this)),
+    mListMode(false),
+    mSearch(new QLineEdit(this)),
+    mList(new QListView(this)),
+    mModel(new LXQtGroupPopupModel(this)),
+    mFilter(new QSortFilterProxyModel(this)),
+    mPreview(new QLabel(this)),
+    mPreviewY(0)
 {
     Q_ASSERT(group);
     setAcceptDrops(true);
@@ -57,26 +126,172 @@ LXQtGroupPopup::LXQtGroupPopup(LXQtTaskGroup *group):
     layout()->setSpacing(3);
     layout()->setMargin(3);
 
+    mButtons->setLayout(new QVBoxLayout);
+    mButtons->layout()->setSpacing(3);
+    mButtons->layout()->setMargin(0);
+    layout()->addWidget(mButtons);
+
+    mSearch->setPlaceholderText(tr("Search..."));
+    mSearch->setClearButtonEnabled(true);
+    mSearch->hide();
+    mSearch->installEventFilter(this);
+    layout()->addWidget(mSearch);
+
+    mFilter->setSourceModel(mModel);
+    mFilter->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    mList->setModel(mFilter);
+    mList->setUniformItemSizes(true);
+    mList->setFrameShape(QFrame::NoFrame);
+    mList->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    mList->setTextElideMode(Qt::ElideRight);
+    mList->setMouseTracking(true);
+    mList->setContextMenuPolicy(Qt::CustomContextMenu);
+    mList->viewport()->installEventFilter(this);
+    mList->hide();
+    layout()->addWidget(mList);
+
+    connect(mSearch, &QLineEdit::textChanged, mFilter, &QSortFilterProxyModel::setFilterFixedString);
+    connect(mList, &QListView::clicked, this, &LXQtGroupPopup::activateIndex);
+    connect(mList, &QWidget::customContextMenuRequested, this, &LXQtGroupPopup::showListContextMenu);
+    connect(mList, &QListView::entered, this, [this] (const QModelIndex & index) {
+        showPreview(mModel->button(mFilter->mapToSource(index)), mList->viewport()->mapToGlobal(mList->visualRect(index).topLeft()).y());
+    });
+
     connect(&mCloseTimer, &QTimer::timeout, this, &LXQtGroupPopup::closeTimerSlot);
     mCloseTimer.setSingleShot(true);
     mCloseTimer.setInterval(400);
+
+    mPreview->setWindowFlags(Qt::FramelessWindowHint | Qt::ToolTip);
+    mPreview->setAttribute(Qt::WA_TransparentForMouseEvents);
+    mPreview->setFrameShape(QFrame::StyledPanel);
+    mPreview->hide();
 }
 
 LXQtGroupPopup::~LXQtGroupPopup() = default;
 
+void LXQtGroupPopup::addButton(LXQtTaskButton* button)
+{
+    mButtons->layout()->addWidget(button);
+    // watch hovering for the window previews
+    button->installEventFilter(this);
+    if (mThumbnailer && !mListMode && !mWatchedWindows.contains(button->windowId()))
+    {
+        mThumbnailer->watch(button->windowId());
+        mWatchedWindows.append(button->windowId());
+    }
+}
+
+void LXQtGroupPopup::removeWidget(QWidget *button)
+{
+    button->removeEventFilter(this);
+    if (button == mPreviewButton)
+        hidePreview();
+    LXQtTaskButton const * const taskButton = qobject_cast<LXQtTaskButton const *>(button);
+    if (mThumbnailer && taskButton && mWatchedWindows.removeOne(taskButton->windowId()))
+        mThumbnailer->release(taskButton->windowId());
+    mButtons->layout()->removeWidget(button);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::setListMode(bool listMode)
+{
+    if (mListMode != listMode)
+    {
+        mListMode = listMode;
+        mButtons->setVisible(!mListMode);
+        mSearch->setVisible(mListMode);
+        mList->setVisible(mListMode);
+        if (!mListMode)
+        {
+            mSearch->clear();
+            mModel->setButtons({});
+            releaseKeyboard();
+        }
+    }
+
+    if (mListMode)
+        refreshList();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::refreshList()
+{
+    // only pointers are collected here, no widget is shown for the rows
+    QList<LXQtTaskButton *> buttons;
+    QLayout* l = mButtons->layout();
+    for (int i = 0; l->count() > i; ++i)
+    {
+        LXQtTaskButton * const button = qobject_cast<LXQtTaskButton *>(l->itemAt(i)->widget());
+        if (nullptr != button && !button->isHidden())
+            buttons.append(button);
+    }
+    mModel->setButtons(buttons);
+    mList->setIconSize(mGroup->iconSize());
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::buttonChanged(LXQtTaskButton * button)
+{
+    if (mListMode)
+        mModel->buttonChanged(button);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::activateIndex(const QModelIndex & index)
+{
+    LXQtTaskButton * const button = mModel->button(mFilter->mapToSource(index));
+    if (nullptr == button)
+        return;
+
+    // the same as releasing the mouse on the button
+    if (button->isChecked())
+        button->minimizeApplication();
+    else
+        button->raiseApplication();
+    hide(true);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtGroupPopup::showListContextMenu(const QPoint & pos)
+{
+    LXQtTaskButton * const button = mModel->button(mFilter->mapToSource(mList->indexAt(pos)));
+    if (nullptr == button)
+        return;
+
+    // let the (hidden) button show its own menu at the cursor position
+    const QPoint globalPos = mList->viewport()->mapToGlobal(pos);
+    QContextMenuEvent event{QContextMenuEvent::Mouse, button->mapFromGlobal(globalPos), globalPos};
+    QCoreApplication::sendEvent(button, &event);
+}
+
 void LXQtGroupPopup::dropEvent(QDropEvent *event)
 {
+    // reordering is not possible in the list mode
+    if (mListMode)
+        return;
+
     qlonglong temp;
     QDataStream stream(event->mimeData()->data(LXQtTaskButton::mimeDataFormat()));
     stream >> temp;
     WId window = (WId) temp;
 
+    QLayout * const buttons_layout = mButtons->layout();
     LXQtTaskButton *button = nullptr;
     int oldIndex(0);
     // get current position of the button being dragged
-    for (int i = 0; i < layout()->count(); i++)
+    for (int i = 0; i < buttons_layout->count(); i++)
     {
-        LXQtTaskButton *b = qobject_cast<LXQtTaskButton*>(layout()->itemAt(i)->widget());
+        LXQtTaskButton *b = qobject_cast<LXQtTaskButton*>(buttons_layout->itemAt(i)->widget());
         if (b && b->windowId() == window)
         {
             button = b;
@@ -88,26 +303,27 @@ void LXQtGroupPopup::dropEvent(QDropEvent *event)
     if (button == nullptr)
         return;
 
+    const int y = mButtons->mapFrom(this, event->pos()).y();
     int newIndex = -1;
     // find the new position to place it in
     for (int i = 0; i < oldIndex && newIndex == -1; i++)
     {
-        QWidget *w = layout()->itemAt(i)->widget();
-        if (w && w->pos().y() + w->height() / 2 > event->pos().y())
+        QWidget *w = buttons_layout->itemAt(i)->widget();
+        if (w && w->pos().y() + w->height() / 2 > y)
             newIndex = i;
     }
-    const int size = layout()->count();
+    const int size = buttons_layout->count();
     for (int i = size - 1; i > oldIndex && newIndex == -1; i--)
     {
-        QWidget *w = layout()->itemAt(i)->widget();
-        if (w && w->pos().y() + w->height() / 2 < event->pos().y())
+        QWidget *w = buttons_layout->itemAt(i)->widget();
+        if (w && w->pos().y() + w->height() / 2 < y)
             newIndex = i;
     }
 
     if (newIndex == -1 || newIndex == oldIndex)
         return;
 
-    QVBoxLayout * l = qobject_cast<QVBoxLayout *>(layout());
+    QVBoxLayout * l = qobject_cast<QVBoxLayout *>(buttons_layout);
     l->takeAt(oldIndex);
     l->insertWidget(newIndex, button);
     l->invalidate();
@@ -131,6 +347,8 @@ void LXQtGroupPopup::dragLeaveEvent(QDragLeaveEvent *event)
  ************************************************/
 void LXQtGroupPopup::leaveEvent(QEvent * /*event*/)
 {
+    if (mListMode)
+        releaseKeyboard();
     mCloseTimer.start();
 }
 
@@ -142,6 +360,38 @@ void LXQtGroupPopup::enterEvent(QEvent * /*event*/)
     mCloseTimer.stop();
 }
 
+/************************************************
+ *
+ ************************************************/
+void LXQtGroupPopup::keyPressEvent(QKeyEvent * event)
+{
+    if (!mListMode)
+    {
+        QFrame::keyPressEvent(event);
+        return;
+    }
+
+    switch (event->key())
+    {
+    case Qt::Key_Up:
+    case Qt::Key_Down:
+    case Qt::Key_PageUp:
+    case Qt::Key_PageDown:
+        QCoreApplication::sendEvent(mList, event);
+        break;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        activateIndex(mList->currentIndex().isValid() ? mList->currentIndex() : mFilter->index(0, 0));
+        break;
+    case Qt::Key_Escape:
+        hide(true);
+        break;
+    default:
+        QCoreApplication::sendEvent(mSearch, event);
+        break;
+    }
+}
+
 void LXQtGroupPopup::paintEvent(QPaintEvent * /*event*/)
 {
     QPainter p(this);
@@ -150,6 +400,125 @@ void LXQtGroupPopup::paintEvent(QPaintEvent * /*event*/)
     style()->drawPrimitive(QStyle::PE_Widget, &opt, &p, this);
 }
 
+void LXQtGroupPopup::showEvent(QShowEvent * event)
+{
+    mThumbnailer = mGroup->parentTaskBar()->thumbnailer();
+    if (mThumbnailer)
+    {
+        connect(mThumbnailer, &LXQtTaskThumbnailer::thumbnailChanged, this, &LXQtGroupPopup::onThumbnailChanged, Qt::UniqueConnection);
+        // the windows are captured only while the popup is shown,
+        // in the list mode only the hovered ones
+        QLayout* l = mButtons->layout();
+        for (int i = 0; !mListMode && l->count() > i; ++i)
+        {
+            LXQtTaskButton const * const button = qobject_cast<LXQtTaskButton const *>(l->itemAt(i)->widget());
+            if (nullptr != button && !button->isHidden())
+            {
+                mThumbnailer->watch(button->windowId());
+                mWatchedWindows.append(button->windowId());
+            }
+        }
+    }
+    QFrame::showEvent(event);
+}
+
+void LXQtGroupPopup::hideEvent(QHideEvent * event)
+{
+    releaseKeyboard();
+    mSearch->clear();
+    hidePreview();
+    if (mThumbnailer)
+    {
+        disconnect(mThumbnailer, &LXQtTaskThumbnailer::thumbnailChanged, this, &LXQtGroupPopup::onThumbnailChanged);
+        for (WId window : qAsConst(mWatchedWindows))
+            mThumbnailer->release(window);
+    }
+    mWatchedWindows.clear();
+    mThumbnailer = nullptr;
+    QFrame::hideEvent(event);
+}
+
+bool LXQtGroupPopup::eventFilter(QObject * watched, QEvent * event)
+{
+    if (watched == mSearch)
+    {
+        // the popup can't get the focus; the keyboard is grabbed for the type-ahead
+        // only after clicking into the search field, not just by hovering the popup
+        if (event->type() == QEvent::MouseButtonPress && mListMode)
+            grabKeyboard();
+    }
+    else if (watched == mList->viewport())
+    {
+        if (event->type() == QEvent::Leave)
+            hidePreview();
+        else if (event->type() == QEvent::MouseButtonRelease
+                && static_cast<QMouseEvent *>(event)->button() == Qt::MiddleButton
+                && mGroup->parentTaskBar()->closeOnMiddleClick())
+        {
+            LXQtTaskButton * const button = mModel->button(mFilter->mapToSource(mList->indexAt(static_cast<QMouseEvent *>(event)->pos())));
+            if (nullptr != button)
+                button->closeApplication();
+        }
+    }
+    else if (event->type() == QEvent::Enter)
+    {
+        LXQtTaskButton * const button = qobject_cast<LXQtTaskButton *>(watched);
+        if (nullptr != button)
+            showPreview(button, button->mapToGlobal(QPoint{0, 0}).y());
+    }
+    else if (event->type() == QEvent::Leave && watched == mPreviewButton)
+        hidePreview();
+    return QFrame::eventFilter(watched, event);
+}
+
+void LXQtGroupPopup::showPreview(LXQtTaskButton * button, int y)
+{
+    mPreviewButton = button;
+    mPreviewY = y;
+    if (!mThumbnailer || !mPreviewButton)
+        return;
+
+    const WId window = mPreviewButton->windowId();
+    if (!mWatchedWindows.contains(window))
+    {
+        mThumbnailer->watch(window);
+        mWatchedWindows.append(window);
+    }
+    onThumbnailChanged(window);
+}
+
+void LXQtGroupPopup::hidePreview()
+{
+    mPreviewButton = nullptr;
+    mPreview->hide();
+}
+
+void LXQtGroupPopup::onThumbnailChanged(WId window)
+{
+    if (!mPreviewButton || mPreviewButton->windowId() != window)
+        return;
+
+    const QImage thumbnail = mThumbnailer->thumbnail(window);
+    if (thumbnail.isNull())
+    {
+        // not captured yet, shown once the capture is done
+        mPreview->hide();
+        return;
+    }
+    mPreview->setPixmap(QPixmap::fromImage(thumbnail));
+    mPreview->adjustSize();
+
+    // place the preview next to the popup, at the level of the hovered button
+    const QRect popup = geometry();
+    const QRect available = screen()->availableGeometry();
+    QPoint pos{popup.right() + 1, mPreviewY};
+    if (pos.x() + mPreview->width() > available.right())
+        pos.setX(popup.left() - mPreview->width());
+    pos.setY(qBound(available.top(), pos.y(), available.bottom() - mPreview->height()));
+    mPreview->move(pos);
+    mPreview->show();
+}
+
 void LXQtGroupPopup::hide(bool fast)
 {
     if (fast)
@@ -167,7 +536,7 @@ void LXQtGroupPopup::show()
 void LXQtGroupPopup::closeTimerSlot()
 {
     bool button_has_dnd_hover = false;
-    QLayout* l = layout();
+    QLayout* l = mButtons->layout();
     for (int i = 0; l->count() > i; ++i)
     {
         LXQtTaskButton const * const button = dynamic_cast<LXQtTaskButton const *>(l->itemAt(i)->widget());
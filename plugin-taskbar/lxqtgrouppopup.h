@@ -36,11 +36,40 @@
 #include <QLayout>
 #include <QTimer>
 #include <QEvent>
+#include <QPointer>
+#include <QAbstractListModel>
 
 #include "lxqttaskbutton.h"
 #include "lxqttaskgroup.h"
 #include "lxqttaskbar.h"
 
+class QLabel;
+class QLineEdit;
+class QListView;
+class QSortFilterProxyModel;
+class LXQtTaskThumbnailer;
+
+/*! Model of the (visible) buttons of a group, used by the popup in list mode.
+ * The buttons serve as data holders only, they are never shown in that mode.
+ */
+class LXQtGroupPopupModel: public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    using QAbstractListModel::QAbstractListModel;
+
+    int rowCount(const QModelIndex & parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const override;
+
+    void setButtons(const QList<LXQtTaskButton *> & buttons);
+    void buttonChanged(LXQtTaskButton * button);
+    LXQtTaskButton * button(const QModelIndex & index) const;
+
+private:
+    QList<LXQtTaskButton *> mButtons;
+};
+
 class LXQtGroupPopup: public QFrame
 {
     Q_OBJECT
@@ -53,12 +82,20 @@ public:
     void show();
 
     // Layout
-    int indexOf(LXQtTaskButton *button) { return layout()->indexOf(button); }
-    int count() { return layout()->count(); }
-    QLayoutItem * itemAt(int i) { return layout()->itemAt(i); }
-    int spacing() { return layout()->spacing(); }
-    void addButton(LXQtTaskButton* button) { layout()->addWidget(button); }
-    void removeWidget(QWidget *button) { layout()->removeWidget(button); }
+    int indexOf(LXQtTaskButton *button) { return mButtons->layout()->indexOf(button); }
+    int count() { return mButtons->layout()->count(); }
+    QLayoutItem * itemAt(int i) { return mButtons->layout()->itemAt(i); }
+    int spacing() { return mButtons->layout()->spacing(); }
+    void addButton(LXQtTaskButton* button);
+    void removeWidget(QWidget *button);
+
+    /*! In list mode the buttons are replaced by a scrollable, searchable list
+     * view, which creates/paints only the rows actually visible
+     */
+    void setListMode(bool listMode);
+    bool isListMode() const { return mListMode; }
+    //! Notifies the list about a changed text/icon of the button
+    void buttonChanged(LXQtTaskButton * button);
 
 protected:
     void dragEnterEvent(QDragEnterEvent * event);
@@ -67,12 +104,34 @@ protected:
     void leaveEvent(QEvent * event);
     void enterEvent(QEvent * event);
     void paintEvent(QPaintEvent * event);
+    void showEvent(QShowEvent * event);
+    void hideEvent(QHideEvent * event);
+    void keyPressEvent(QKeyEvent * event);
+    bool eventFilter(QObject * watched, QEvent * event);
 
     void closeTimerSlot();
 
 private:
+    void refreshList();
+    void activateIndex(const QModelIndex & index);
+    void showListContextMenu(const QPoint & pos);
+    void showPreview(LXQtTaskButton * button, int y);
+    void hidePreview();
+    void onThumbnailChanged(WId window);
+
     LXQtTaskGroup *mGroup;
     QTimer mCloseTimer;
+    QWidget *mButtons;
+    bool mListMode;
+    QLineEdit *mSearch;
+    QListView *mList;
+    LXQtGroupPopupModel *mModel;
+    QSortFilterProxyModel *mFilter;
+    QLabel *mPreview;
+    QPointer<LXQtTaskButton> mPreviewButton;
+    int mPreviewY; //!< global y coordinate of the hovered button/row
+    QPointer<LXQtTaskThumbnailer> mThumbnailer; //!< set while the popup is shown with thumbnails enabled
+    QList<WId> mWatchedWindows;
 };
 
 #endif // LXQTTASKPOPUP_H
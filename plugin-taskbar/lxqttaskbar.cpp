@@ -46,6 +46,7 @@
 
 #include "lxqttaskbar.h"
 #include "lxqttaskgroup.h"
+#include "lxqttaskbarrecorder.h"
 
 using namespace LXQt;
 
@@ -71,7 +72,10 @@ LXQtTaskBar::LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget *parent) :
     mIconByClass(false),
     mWheelEventsAction(1),
     mWheelDeltaThreshold(300),
+    mShowThumbnails(false),
     mPlugin(plugin),
+    mThumbnailer(new LXQtTaskThumbnailer(this)),
+    mRecorder(LXQtTaskBarRecorder::create(this)),
     mPlaceHolder(new QWidget(this)),
     mStyle(new LeftAlignedTextStyle())
 {
@@ -93,6 +97,10 @@ LXQtTaskBar::LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget *parent) :
     connect(mSignalMapper, &QSignalMapper::mappedInt, this, &LXQtTaskBar::activateTask);
     QTimer::singleShot(0, this, &LXQtTaskBar::registerShortcuts);
 
+    // a replayed recording replaces the real windows
+    if (mRecorder && mRecorder->isReplaying())
+        return;
+
     connect(KX11Extras::self(), static_cast<void (KX11Extras::*)(WId, NET::Properties, NET::Properties2)>(&KX11Extras::windowChanged)
             , this, &LXQtTaskBar::onWindowChanged);
     connect(KX11Extras::self(), &KX11Extras::windowAdded, this, &LXQtTaskBar::onWindowAdded);
@@ -298,15 +306,7 @@ void LXQtTaskBar::addWindow(WId window)
 
     if (!group)
     {
-        group = new LXQtTaskGroup(group_id, window, this);
-        connect(group, &LXQtTaskGroup::groupBecomeEmpty,  this, &LXQtTaskBar::groupBecomeEmptySlot);
-        connect(group, &LXQtTaskGroup::visibilityChanged, this, &LXQtTaskBar::refreshPlaceholderVisibility);
-        connect(group, &LXQtTaskGroup::popupShown,        this, &LXQtTaskBar::popupShown);
-        connect(group, &LXQtTaskButton::dragging,         this, [this] (QObject * dragSource, QPoint const & pos) {
-            buttonMove(qobject_cast<LXQtTaskGroup *>(sender()), qobject_cast<LXQtTaskGroup *>(dragSource), pos);
-        });
-        mLayout->addWidget(group);
-        group->setToolButtonsStyle(mButtonStyle);
+        group = addGroup(new LXQtTaskGroup(group_id, window, this));
 
         if (mUngroupedNextToExisting)
         {
@@ -337,6 +337,89 @@ void LXQtTaskBar::addWindow(WId window)
     group->addWindow(window);
 }
 
+/************************************************
+
+ ************************************************/
+LXQtTaskGroup * LXQtTaskBar::addGroup(LXQtTaskGroup * group)
+{
+    connect(group, &LXQtTaskGroup::groupBecomeEmpty,  this, &LXQtTaskBar::groupBecomeEmptySlot);
+    connect(group, &LXQtTaskGroup::visibilityChanged, this, &LXQtTaskBar::refreshPlaceholderVisibility);
+    connect(group, &LXQtTaskGroup::popupShown,        this, &LXQtTaskBar::popupShown);
+    connect(group, &LXQtTaskButton::dragging,         this, [this] (QObject * dragSource, QPoint const & pos) {
+        buttonMove(qobject_cast<LXQtTaskGroup *>(sender()), qobject_cast<LXQtTaskGroup *>(dragSource), pos);
+    });
+    mLayout->addWidget(group);
+    group->setToolButtonsStyle(mButtonStyle);
+    return group;
+}
+
+/************************************************
+ Moves the existing buttons into groups matching the current
+ grouping settings. The buttons (with their icons and texts)
+ are kept, only the group buttons are recreated.
+ ************************************************/
+void LXQtTaskBar::regroupWindows()
+{
+    QList<LXQtTaskGroup *> old_groups;
+    for (int i = 0; i < mLayout->count(); ++i)
+    {
+        LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup*>(mLayout->itemAt(i)->widget());
+        if (nullptr != group)
+            old_groups.append(group);
+    }
+
+    // detach all buttons, preserving their current order
+    QList<LXQtTaskButton *> buttons;
+    for (LXQtTaskGroup * group : qAsConst(old_groups))
+    {
+        buttons.append(group->takeButtons());
+        mLayout->removeWidget(group);
+        group->deleteLater();
+    }
+    mKnownWindows.clear();
+
+    // Windows of the same class are kept together if grouped or when
+    // ungrouped windows should be placed next to the existing ones
+    // (which is the order the sequential placement in addWindow() produces).
+    const bool by_class = mGroupingEnabled || mUngroupedNextToExisting;
+    QStringList keys;
+    QHash<QString, QList<LXQtTaskButton *>> clusters;
+    for (LXQtTaskButton * button : qAsConst(buttons))
+    {
+        // the class is kept by the button, no X round trip per window
+        const QString key = by_class ? button->windowClass() : QString::number(button->windowId());
+        auto i_cluster = clusters.find(key);
+        if (clusters.end() == i_cluster)
+        {
+            keys.append(key);
+            i_cluster = clusters.insert(key, {});
+        }
+        i_cluster->append(button);
+    }
+
+    for (const QString & key : qAsConst(keys))
+    {
+        const QList<LXQtTaskButton *> & cluster = clusters[key];
+        if (mGroupingEnabled)
+        {
+            LXQtTaskGroup * group = addGroup(new LXQtTaskGroup(key, cluster.first(), this));
+            group->addButtons(cluster);
+            for (LXQtTaskButton * button : cluster)
+                mKnownWindows[button->windowId()] = group;
+        } else
+        {
+            for (LXQtTaskButton * button : cluster)
+            {
+                LXQtTaskGroup * group = addGroup(new LXQtTaskGroup(QString::number(button->windowId()), button, this));
+                group->addButtons({button});
+                mKnownWindows[button->windowId()] = group;
+            }
+        }
+    }
+
+    emit refreshIconGeometry();
+}
+
 /************************************************
 
  ************************************************/
@@ -354,6 +437,13 @@ auto LXQtTaskBar::removeWindow(windowMap_t::iterator pos) -> windowMap_t::iterat
  ************************************************/
 void LXQtTaskBar::refreshTaskList()
 {
+    // the replayed windows are not known to the window manager
+    if (mRecorder && mRecorder->isReplaying())
+    {
+        refreshPlaceholderVisibility();
+        return;
+    }
+
     QList<WId> new_list;
     // Just add new windows to groups, deleting is up to the groups
     const auto wnds = KX11Extras::stackingOrder();
@@ -384,6 +474,7 @@ void LXQtTaskBar::refreshTaskList()
  ************************************************/
 void LXQtTaskBar::onWindowChanged(WId window, NET::Properties prop, NET::Properties2 prop2)
 {
+    LXQtTaskBarRecorder::Measure measure{mRecorder, LXQtTaskBarRecorder::WindowChanged, window, prop, prop2};
     auto i = mKnownWindows.find(window);
     if (mKnownWindows.end() != i)
     {
@@ -396,6 +487,7 @@ void LXQtTaskBar::onWindowChanged(WId window, NET::Properties prop, NET::Propert
 
 void LXQtTaskBar::onWindowAdded(WId window)
 {
+    LXQtTaskBarRecorder::Measure measure{mRecorder, LXQtTaskBarRecorder::WindowAdded, window};
     auto const pos = mKnownWindows.find(window);
     if (mKnownWindows.end() == pos && acceptWindow(window))
         addWindow(window);
@@ -406,6 +498,7 @@ void LXQtTaskBar::onWindowAdded(WId window)
  ************************************************/
 void LXQtTaskBar::onWindowRemoved(WId window)
 {
+    LXQtTaskBarRecorder::Measure measure{mRecorder, LXQtTaskBarRecorder::WindowRemoved, window};
     auto const pos = mKnownWindows.find(window);
     if (mKnownWindows.end() != pos)
     {
@@ -498,21 +591,12 @@ void LXQtTaskBar::settingsChanged()
     mIconByClass = mPlugin->settings()->value(QStringLiteral("iconByClass"), false).toBool();
     mWheelEventsAction = mPlugin->settings()->value(QStringLiteral("wheelEventsAction"), 1).toInt();
     mWheelDeltaThreshold = mPlugin->settings()->value(QStringLiteral("wheelDeltaThreshold"), 300).toInt();
+    mShowThumbnails = mPlugin->settings()->value(QStringLiteral("showThumbnails"), false).toBool();
+    mThumbnailer->setRefreshRate(mPlugin->settings()->value(QStringLiteral("thumbnailRefreshRate"), 10).toInt());
 
-    // Delete all groups if grouping or ungrouped next to existing feature toggled and start over
+    // Move the existing buttons into new groups if grouping or ungrouped next to existing feature toggled
     if (groupingEnabledOld != mGroupingEnabled || ungroupedNextToExistingOld != mUngroupedNextToExisting)
-    {
-        for (int i = mLayout->count() - 1; 0 <= i; --i)
-        {
-            LXQtTaskGroup * group = qobject_cast<LXQtTaskGroup*>(mLayout->itemAt(i)->widget());
-            if (nullptr != group)
-            {
-                mLayout->takeAt(i);
-                group->deleteLater();
-            }
-        }
-        mKnownWindows.clear();
-    }
+        regroupWindows();
 
     if (showOnlyOneDesktopTasksOld != mShowOnlyOneDesktopTasks
             || (mShowOnlyOneDesktopTasks && showDesktopNumOld != mShowDesktopNum)
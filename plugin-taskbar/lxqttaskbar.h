@@ -37,6 +37,7 @@
 #include "lxqttaskbarconfiguration.h"
 #include "lxqttaskgroup.h"
 #include "lxqttaskbutton.h"
+#include "lxqttaskthumbnailer.h"
 
 #include <QFrame>
 #include <QBoxLayout>
@@ -49,6 +50,7 @@
 
 class QSignalMapper;
 class LXQtTaskButton;
+class LXQtTaskBarRecorder;
 class ElidedButtonStyle;
 
 namespace LXQt {
@@ -59,6 +61,8 @@ class LXQtTaskBar : public QFrame
 {
     Q_OBJECT
 
+    friend class LXQtTaskBarRecorder;
+
 public:
     explicit LXQtTaskBar(ILXQtPanelPlugin *plugin, QWidget* parent = nullptr);
     virtual ~LXQtTaskBar();
@@ -79,6 +83,8 @@ public:
     bool isIconByClass() const { return mIconByClass; }
     int wheelEventsAction() const { return mWheelEventsAction; }
     int wheelDeltaThreshold() const { return mWheelDeltaThreshold; }
+    //! \return the thumbnailer if window previews are enabled and can be captured
+    LXQtTaskThumbnailer * thumbnailer() const { return mShowThumbnails && mThumbnailer->isAvailable() ? mThumbnailer : nullptr; }
     inline ILXQtPanel * panel() const { return mPlugin->panel(); }
     inline ILXQtPanelPlugin * plugin() const { return mPlugin; }
 
@@ -114,6 +120,8 @@ private:
 
 private:
     void addWindow(WId window);
+    LXQtTaskGroup * addGroup(LXQtTaskGroup * group);
+    void regroupWindows();
     windowMap_t::iterator removeWindow(windowMap_t::iterator pos);
     void buttonMove(LXQtTaskGroup * dst, LXQtTaskGroup * src, QPoint const & pos);
 
@@ -140,6 +148,7 @@ private:
     bool mIconByClass;
     int mWheelEventsAction;
     int mWheelDeltaThreshold;
+    bool mShowThumbnails;
 
     bool acceptWindow(WId window) const;
     void setButtonStyle(Qt::ToolButtonStyle buttonStyle);
@@ -149,6 +158,8 @@ private:
     void resizeEvent(QResizeEvent *event);
 
     ILXQtPanelPlugin *mPlugin;
+    LXQtTaskThumbnailer *mThumbnailer;
+    LXQtTaskBarRecorder *mRecorder;
     QWidget *mPlaceHolder;
     LeftAlignedTextStyle *mStyle;
 };
@@ -78,6 +78,9 @@ LXQtTaskbarConfiguration::LXQtTaskbarConfiguration(PluginSettings *settings, QWi
         ui->ungroupedNextToExistingCB->setEnabled(!(ui->groupingGB->isChecked()));
     });
     connect(ui->showGroupOnHoverCB, &QAbstractButton::clicked, this, &LXQtTaskbarConfiguration::saveSettings);
+    connect(ui->showThumbnailsCB, &QAbstractButton::clicked, this, &LXQtTaskbarConfiguration::saveSettings);
+    connect(ui->showThumbnailsCB, &QCheckBox::stateChanged, ui->thumbnailRefreshRateSB, &QWidget::setEnabled);
+    connect(ui->thumbnailRefreshRateSB, &QAbstractSpinBox::editingFinished, this, &LXQtTaskbarConfiguration::saveSettings);
     connect(ui->ungroupedNextToExistingCB, &QAbstractButton::clicked, this, &LXQtTaskbarConfiguration::saveSettings);
     connect(ui->iconByClassCB, &QAbstractButton::clicked, this, &LXQtTaskbarConfiguration::saveSettings);
     connect(ui->wheelEventsActionCB, QOverload<int>::of(&QComboBox::activated), this, &LXQtTaskbarConfiguration::saveSettings);
@@ -106,6 +109,10 @@ void LXQtTaskbarConfiguration::loadSettings()
     ui->buttonHeightSB->setValue(settings().value(QStringLiteral("buttonHeight"), 100).toInt());
     ui->groupingGB->setChecked(settings().value(QStringLiteral("groupingEnabled"),true).toBool());
     ui->showGroupOnHoverCB->setChecked(settings().value(QStringLiteral("showGroupOnHover"),true).toBool());
+    const bool showThumbnails = settings().value(QStringLiteral("showThumbnails"), false).toBool();
+    ui->showThumbnailsCB->setChecked(showThumbnails);
+    ui->thumbnailRefreshRateSB->setValue(settings().value(QStringLiteral("thumbnailRefreshRate"), 10).toInt());
+    ui->thumbnailRefreshRateSB->setEnabled(showThumbnails);
     ui->ungroupedNextToExistingCB->setChecked(settings().value(QStringLiteral("ungroupedNextToExisting"),false).toBool());
     ui->iconByClassCB->setChecked(settings().value(QStringLiteral("iconByClass"), false).toBool());
     ui->wheelEventsActionCB->setCurrentIndex(ui->wheelEventsActionCB->findData(settings().value(QStringLiteral("wheelEventsAction"), 0).toInt()));
@@ -126,6 +133,8 @@ void LXQtTaskbarConfiguration::saveSettings()
     settings().setValue(QStringLiteral("raiseOnCurrentDesktop"), ui->raiseOnCurrentDesktopCB->isChecked());
     settings().setValue(QStringLiteral("groupingEnabled"),ui->groupingGB->isChecked());
     settings().setValue(QStringLiteral("showGroupOnHover"),ui->showGroupOnHoverCB->isChecked());
+    settings().setValue(QStringLiteral("showThumbnails"),ui->showThumbnailsCB->isChecked());
+    settings().setValue(QStringLiteral("thumbnailRefreshRate"),ui->thumbnailRefreshRateSB->value());
     settings().setValue(QStringLiteral("ungroupedNextToExisting"),ui->ungroupedNextToExistingCB->isChecked());
     settings().setValue(QStringLiteral("iconByClass"),ui->iconByClassCB->isChecked());
     settings().setValue(QStringLiteral("wheelEventsAction"),ui->wheelEventsActionCB->itemData(ui->wheelEventsActionCB->currentIndex()));
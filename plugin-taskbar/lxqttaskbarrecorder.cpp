@@ -0,0 +1,284 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqttaskbarrecorder.h"
+#include "lxqttaskbar.h"
+
+#include <QDebug>
+#include <QTextStream>
+#include <QTimer>
+#include <QX11Info>
+#include <KWindowSystem/KWindowInfo>
+
+#include <xcb/xcb.h>
+#include <algorithm>
+
+namespace
+{
+    const char * const EVENT_NAMES[] = {"added", "removed", "changed"};
+
+    unsigned int currentSequence()
+    {
+        // the sequence number of a (no-op) request tells how many requests were issued before it
+        return xcb_no_operation(QX11Info::connection()).sequence;
+    }
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarRecorder * LXQtTaskBarRecorder::create(LXQtTaskBar * taskbar)
+{
+    if (!QX11Info::connection())
+        return nullptr;
+
+    const QString replayFile = QString::fromLocal8Bit(qgetenv("LXQT_TASKBAR_REPLAY"));
+    if (!replayFile.isEmpty())
+    {
+        LXQtTaskBarRecorder * recorder = new LXQtTaskBarRecorder(taskbar, true);
+        bool ok = false;
+        const qreal speed = qgetenv("LXQT_TASKBAR_REPLAY_SPEED").toDouble(&ok);
+        if (ok && 0 <= speed)
+            recorder->mReplaySpeed = speed;
+        if (recorder->load(replayFile))
+            return recorder;
+        delete recorder;
+        return nullptr;
+    }
+
+    const QString recordFile = QString::fromLocal8Bit(qgetenv("LXQT_TASKBAR_RECORD"));
+    if (!recordFile.isEmpty())
+    {
+        LXQtTaskBarRecorder * recorder = new LXQtTaskBarRecorder(taskbar, false);
+        recorder->mFile.setFileName(recordFile);
+        if (recorder->mFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+            return recorder;
+        qWarning() << "Unable to record the taskbar events into" << recordFile;
+        delete recorder;
+    }
+    return nullptr;
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarRecorder::LXQtTaskBarRecorder(LXQtTaskBar * taskbar, bool replaying)
+    : QObject(taskbar)
+    , mTaskBar(taskbar)
+    , mReplaying(replaying)
+    , mReplayPos(0)
+    , mReplaySpeed(1.0)
+    , mRequests(0)
+{
+    mClock.start();
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarRecorder::~LXQtTaskBarRecorder()
+{
+    if (!mReplaying && !mLatencies.isEmpty())
+        report();
+
+    xcb_connection_t * c = QX11Info::connection();
+    for (WId stub : qAsConst(mStubs))
+        xcb_destroy_window(c, stub);
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskBarRecorder::Measure::Measure(LXQtTaskBarRecorder * recorder, Event event, WId window, NET::Properties prop, NET::Properties2 prop2)
+    : mRecorder(recorder)
+    , mEvent(event)
+    , mWindow(window)
+    , mProp(prop)
+    , mProp2(prop2)
+    , mSequence(0)
+{
+    if (mRecorder)
+    {
+        mSequence = currentSequence();
+        mTimer.start();
+    }
+}
+
+LXQtTaskBarRecorder::Measure::~Measure()
+{
+    if (mRecorder)
+    {
+        const qint64 nsecs = mTimer.nsecsElapsed();
+        mRecorder->record(mEvent, mWindow, mProp, mProp2, nsecs, currentSequence() - mSequence - 1);
+    }
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarRecorder::record(Event event, WId window, NET::Properties prop, NET::Properties2 prop2, qint64 nsecs, unsigned int requests)
+{
+    mLatencies.append(nsecs);
+    mRequests += requests;
+
+    if (mReplaying)
+        return;
+
+    QByteArray windowClass;
+    QString title;
+    if (event != WindowRemoved)
+    {
+        KWindowInfo info(window, NET::WMVisibleName | NET::WMName, NET::WM2WindowClass);
+        windowClass = info.windowClassClass();
+        title = info.visibleName().isEmpty() ? info.name() : info.visibleName();
+    }
+
+    QTextStream out(&mFile);
+    out << mClock.elapsed() << '\t' << EVENT_NAMES[event] << '\t' << window
+        << '\t' << static_cast<int>(prop) << '\t' << static_cast<int>(prop2)
+        << '\t' << windowClass.toPercentEncoding() << '\t' << title.toUtf8().toPercentEncoding() << '\n';
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskBarRecorder::load(const QString & fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        qWarning() << "Unable to open the taskbar recording" << fileName;
+        return false;
+    }
+
+    while (!file.atEnd())
+    {
+        const QList<QByteArray> fields = file.readLine().trimmed().split('\t');
+        if (fields.count() < 7)
+            continue;
+
+        Record record;
+        record.time = fields.at(0).toLongLong();
+        const auto event = std::find(std::begin(EVENT_NAMES), std::end(EVENT_NAMES), fields.at(1));
+        if (event == std::end(EVENT_NAMES))
+            continue;
+        record.event = static_cast<Event>(event - std::begin(EVENT_NAMES));
+        record.window = fields.at(2).toULong();
+        record.prop = NET::Properties(QFlag(fields.at(3).toInt()));
+        record.prop2 = NET::Properties2(QFlag(fields.at(4).toInt()));
+        record.windowClass = QByteArray::fromPercentEncoding(fields.at(5));
+        record.title = QString::fromUtf8(QByteArray::fromPercentEncoding(fields.at(6)));
+        mRecords.append(record);
+    }
+
+    qDebug() << "Replaying" << mRecords.count() << "taskbar events from" << fileName;
+    // start once the taskbar has read its settings
+    QTimer::singleShot(0, this, &LXQtTaskBarRecorder::replayNext);
+    return true;
+}
+
+/************************************************
+
+ ************************************************/
+WId LXQtTaskBarRecorder::stubWindow(const Record & record)
+{
+    xcb_connection_t * c = QX11Info::connection();
+    const xcb_window_t root = QX11Info::appRootWindow();
+
+    WId stub = mStubs.value(record.window, 0);
+    if (0 == stub)
+    {
+        stub = xcb_generate_id(c);
+        xcb_create_window(c, XCB_COPY_FROM_PARENT, stub, root, 0, 0, 1, 1, 0, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_COPY_FROM_PARENT, 0, nullptr);
+        mStubs.insert(record.window, stub);
+    }
+
+    if (record.event == WindowAdded || record.prop2.testFlag(NET::WM2WindowClass))
+    {
+        // WM_CLASS is "instance\0class\0"
+        const QByteArray wmClass = record.windowClass + '\0' + record.windowClass + '\0';
+        xcb_change_property(c, XCB_PROP_MODE_REPLACE, stub, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING, 8, wmClass.size(), wmClass.constData());
+    }
+    if (record.event == WindowAdded || record.prop.testFlag(NET::WMName) || record.prop.testFlag(NET::WMVisibleName))
+        NETWinInfo(c, stub, root, NET::Properties(), NET::Properties2()).setName(record.title.toUtf8().constData());
+    xcb_flush(c);
+
+    return stub;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarRecorder::replayNext()
+{
+    if (mReplayPos >= mRecords.count())
+    {
+        report();
+        return;
+    }
+
+    // the handlers measure themselves, the same as for the real windows
+    const Record & record = mRecords.at(mReplayPos++);
+    if (record.event == WindowRemoved)
+    {
+        const WId stub = mStubs.take(record.window);
+        if (0 != stub)
+        {
+            mTaskBar->onWindowRemoved(stub);
+            xcb_destroy_window(QX11Info::connection(), stub);
+        }
+    }
+    else
+    {
+        const WId stub = stubWindow(record);
+        if (record.event == WindowAdded)
+            mTaskBar->onWindowAdded(stub);
+        else
+            mTaskBar->onWindowChanged(stub, record.prop, record.prop2);
+    }
+
+    // the next event comes after the recorded delay, at least in the next event loop iteration
+    int delay = 0;
+    if (0 < mReplaySpeed && mReplayPos < mRecords.count())
+        delay = qMax(0, qRound((mRecords.at(mReplayPos).time - record.time) / mReplaySpeed));
+    QTimer::singleShot(delay, Qt::PreciseTimer, this, &LXQtTaskBarRecorder::replayNext);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskBarRecorder::report() const
+{
+    QVector<qint64> latencies = mLatencies;
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies] (int p) {
+        return latencies.isEmpty() ? 0.0 : latencies.at((latencies.count() - 1) * p / 100) / 1000.0;
+    };
+
+    qDebug().nospace() << "Taskbar handled " << latencies.count() << " window events"
+        << ", latency [us] p50: " << percentile(50) << " p90: " << percentile(90)
+        << " p99: " << percentile(99) << " max: " << percentile(100)
+        << ", X requests issued (not round trips): " << mRequests;
+}
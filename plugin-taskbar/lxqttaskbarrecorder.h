@@ -0,0 +1,123 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTTASKBARRECORDER_H
+#define LXQTTASKBARRECORDER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QVector>
+#include <KWindowSystem/NETWM>
+
+class LXQtTaskBar;
+
+/*! Records and replays the window events handled by the taskbar, for
+ * reproducible performance measurements.
+ *
+ * With LXQT_TASKBAR_RECORD=<file> in the environment, every windowAdded/
+ * windowRemoved/windowChanged signal (with the property masks and the
+ * resulting window class and title) is appended to the file.
+ *
+ * With LXQT_TASKBAR_REPLAY=<file> the taskbar ignores the real windows;
+ * the recording is replayed against stub windows created on the X server
+ * (e.g. Xvfb, no window manager needed). The events keep their recorded
+ * timing; LXQT_TASKBAR_REPLAY_SPEED=<factor> speeds the replay up (or slows
+ * it down), 0 replays one event per event loop iteration.
+ *
+ * In both cases the handling latency percentiles and the number of X
+ * requests issued by the taskbar are reported when finished. The requests
+ * are counted by their sequence numbers, so also the ones not waiting for
+ * any reply are included (it is not the number of round trips).
+ */
+class LXQtTaskBarRecorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Event
+    {
+        WindowAdded,
+        WindowRemoved,
+        WindowChanged
+    };
+
+    //! \return a recorder if requested by the environment, nullptr otherwise
+    static LXQtTaskBarRecorder * create(LXQtTaskBar * taskbar);
+    ~LXQtTaskBarRecorder() override;
+
+    bool isReplaying() const { return mReplaying; }
+
+    //! Measures handling of one event (in its scope)
+    class Measure
+    {
+    public:
+        Measure(LXQtTaskBarRecorder * recorder, Event event, WId window, NET::Properties prop = {}, NET::Properties2 prop2 = {});
+        ~Measure();
+
+    private:
+        LXQtTaskBarRecorder * mRecorder;
+        Event mEvent;
+        WId mWindow;
+        NET::Properties mProp;
+        NET::Properties2 mProp2;
+        unsigned int mSequence;
+        QElapsedTimer mTimer;
+    };
+
+private:
+    struct Record
+    {
+        qint64 time;
+        Event event;
+        WId window;
+        NET::Properties prop;
+        NET::Properties2 prop2;
+        QByteArray windowClass;
+        QString title;
+    };
+
+    LXQtTaskBarRecorder(LXQtTaskBar * taskbar, bool replaying);
+
+    void record(Event event, WId window, NET::Properties prop, NET::Properties2 prop2, qint64 nsecs, unsigned int requests);
+    bool load(const QString & fileName);
+    void replayNext();
+    WId stubWindow(const Record & record);
+    void report() const;
+
+    LXQtTaskBar * mTaskBar;
+    bool mReplaying;
+    QFile mFile;
+    QElapsedTimer mClock;
+    QVector<Record> mRecords;
+    int mReplayPos;
+    qreal mReplaySpeed; //!< 0 for ignoring the recorded timing
+    QHash<WId, WId> mStubs; //!< recorded window -> stub window
+    QVector<qint64> mLatencies; //!< nsecs
+    quint64 mRequests;
+};
+
+#endif // LXQTTASKBARRECORDER_H
@@ -94,6 +94,47 @@ LXQtTaskButton::LXQtTaskButton(const WId window, LXQtTaskBar * taskbar, QWidget
 {
     Q_ASSERT(taskbar);
 
+    init();
+
+    updateWindowClass();
+    updateText();
+    updateIcon();
+
+    setUrgencyHint(NETWinInfo(QX11Info::connection(), mWindow, QX11Info::appRootWindow(), NET::Properties{}, NET::WM2Urgency).urgency()
+            || KWindowInfo{mWindow, NET::WMState}.hasState(NET::DemandsAttention));
+}
+
+/************************************************
+ Creates a button for the same window as \p button,
+ taking over its already fetched text, icon and urgency
+ instead of querying them from X again
+ ************************************************/
+LXQtTaskButton::LXQtTaskButton(LXQtTaskButton const * button, QWidget *parent) :
+    QToolButton(parent),
+    mWindow(button->mWindow),
+    mWindowClass(button->mWindowClass),
+    mUrgencyHint(false),
+    mOrigin(Qt::TopLeftCorner),
+    mParentTaskBar(button->mParentTaskBar),
+    mPlugin(button->mPlugin),
+    mIconSize(button->mIconSize),
+    mWheelDelta(0),
+    mDNDTimer(new QTimer(this)),
+    mWheelTimer(new QTimer(this))
+{
+    init();
+
+    setText(button->text());
+    setToolTip(button->toolTip());
+    setIcon(button->icon());
+    setUrgencyHint(button->hasUrgencyHint());
+}
+
+/************************************************
+
+************************************************/
+void LXQtTaskButton::init()
+{
     setCheckable(true);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
@@ -102,9 +143,6 @@ LXQtTaskButton::LXQtTaskButton(const WId window, LXQtTaskBar * taskbar, QWidget
     setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
     setAcceptDrops(true);
 
-    updateText();
-    updateIcon();
-
     mDNDTimer->setSingleShot(true);
     mDNDTimer->setInterval(700);
     connect(mDNDTimer, &QTimer::timeout, this, &LXQtTaskButton::raiseApplication);
@@ -115,9 +153,6 @@ LXQtTaskButton::LXQtTaskButton(const WId window, LXQtTaskBar * taskbar, QWidget
         mWheelDelta = 0; // forget previous wheel deltas
     });
 
-    setUrgencyHint(NETWinInfo(QX11Info::connection(), mWindow, QX11Info::appRootWindow(), NET::Properties{}, NET::WM2Urgency).urgency()
-            || KWindowInfo{mWindow, NET::WMState}.hasState(NET::DemandsAttention));
-
     connect(LXQt::Settings::globalSettings(), &LXQt::GlobalSettings::iconThemeChanged, this, &LXQtTaskButton::updateIcon);
     connect(mParentTaskBar,                   &LXQtTaskBar::iconByClassChanged,        this, &LXQtTaskButton::updateIcon);
 }
@@ -138,6 +173,15 @@ void LXQtTaskButton::updateText()
     setToolTip(title);
 }
 
+/************************************************
+ The class is kept, so the buttons can be regrouped without
+ querying X for it
+ ************************************************/
+void LXQtTaskButton::updateWindowClass()
+{
+    mWindowClass = QString::fromUtf8(KWindowInfo{mWindow, NET::Properties(), NET::WM2WindowClass}.windowClassClass());
+}
+
 /************************************************
 
  ************************************************/
@@ -146,7 +190,7 @@ void LXQtTaskButton::updateIcon()
     QIcon ico;
     if (mParentTaskBar->isIconByClass())
     {
-        ico = XdgIcon::fromTheme(QString::fromUtf8(KWindowInfo{mWindow, NET::Properties(), NET::WM2WindowClass}.windowClassClass()).toLower());
+        ico = XdgIcon::fromTheme(mWindowClass.toLower());
     }
     if (ico.isNull())
     {
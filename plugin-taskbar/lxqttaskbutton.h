@@ -65,6 +65,8 @@ public:
     bool isApplicationHidden() const;
     bool isApplicationActive() const;
     WId windowId() const { return mWindow; }
+    //! \return the WM_CLASS class of the window, as of the last updateWindowClass()
+    QString const & windowClass() const { return mWindowClass; }
 
     bool hasUrgencyHint() const { return mUrgencyHint; }
     void setUrgencyHint(bool set);
@@ -73,6 +75,7 @@ public:
     bool isOnCurrentScreen() const;
     bool isMinimized() const;
     void updateText();
+    void updateWindowClass();
 
     Qt::Corner origin() const;
     virtual void setAutoRotation(bool value, ILXQtPanel::Position position);
@@ -115,6 +118,8 @@ protected:
     virtual void contextMenuEvent(QContextMenuEvent *event);
     void paintEvent(QPaintEvent *);
 
+    LXQtTaskButton(LXQtTaskButton const * button, QWidget *parent);
+
     void setWindowId(WId wid) {mWindow = wid;}
     virtual QMimeData * mimeData();
     static bool sDraggging;
@@ -122,9 +127,11 @@ protected:
     inline ILXQtPanelPlugin * plugin() const { return mPlugin; }
 
 private:
+    void init();
     void moveApplicationToPrevNextDesktop(bool next);
     void moveApplicationToPrevNextMonitor(bool next);
     WId mWindow;
+    QString mWindowClass;
     bool mUrgencyHint;
     QPoint mDragStartPosition;
     Qt::Corner mOrigin;
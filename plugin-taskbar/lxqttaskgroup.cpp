@@ -54,8 +54,34 @@ LXQtTaskGroup::LXQtTaskGroup(const QString &groupName, WId window, LXQtTaskBar *
 {
     Q_ASSERT(parent);
 
-    setObjectName(groupName);
-    setText(groupName);
+    init();
+}
+
+/************************************************
+ Creates the group from an existing button (e.g. when regrouping),
+ reusing its text and icon
+ ************************************************/
+LXQtTaskGroup::LXQtTaskGroup(const QString &groupName, LXQtTaskButton *button, LXQtTaskBar *parent)
+    : LXQtTaskButton(button, parent),
+    mGroupName(groupName),
+    mPopup(new LXQtGroupPopup(this)),
+    mPreventPopup(false),
+    mSingleButton(true)
+{
+    Q_ASSERT(parent);
+
+    init();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskGroup::init()
+{
+    LXQtTaskBar * const parent = parentTaskBar();
+
+    setObjectName(mGroupName);
+    setText(mGroupName);
 
     connect(this,                  &LXQtTaskGroup::clicked,               this, &LXQtTaskGroup::onClicked);
     connect(KX11Extras::self(),    &KX11Extras::currentDesktopChanged,    this, &LXQtTaskGroup::onDesktopChanged);
@@ -110,6 +136,27 @@ LXQtTaskButton * LXQtTaskGroup::addWindow(WId id)
         return mButtonHash.value(id);
 
     LXQtTaskButton *btn = new LXQtTaskButton(id, parentTaskBar(), mPopup);
+    addButton(btn);
+    refreshVisibility();
+
+    return btn;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskGroup::addButtons(const QList<LXQtTaskButton *> & buttons)
+{
+    for (LXQtTaskButton *btn : buttons)
+        addButton(btn);
+    refreshVisibility();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskGroup::addButton(LXQtTaskButton * btn)
+{
     btn->setToolButtonStyle(popupButtonStyle());
 
     if (btn->isApplicationActive())
@@ -118,13 +165,36 @@ LXQtTaskButton * LXQtTaskGroup::addWindow(WId id)
         setChecked(true);
     }
 
-    mButtonHash.insert(id, btn);
+    mButtonHash.insert(btn->windowId(), btn);
     mPopup->addButton(btn);
 
     connect(btn, &LXQtTaskButton::clicked, this, &LXQtTaskGroup::onChildButtonClicked);
-    refreshVisibility();
+}
 
-    return btn;
+/************************************************
+
+ ************************************************/
+QList<LXQtTaskButton *> LXQtTaskGroup::takeButtons()
+{
+    setPopupVisible(false, true);
+
+    QList<LXQtTaskButton *> buttons;
+    for (int i = 0; i < mPopup->count(); ++i)
+    {
+        if (LXQtTaskButton *btn = qobject_cast<LXQtTaskButton *>(mPopup->itemAt(i)->widget()))
+            buttons.append(btn);
+    }
+
+    for (LXQtTaskButton *btn : qAsConst(buttons))
+    {
+        mPopup->removeWidget(btn);
+        disconnect(btn, nullptr, this, nullptr);
+        // don't let the button die together with this group
+        btn->setParent(nullptr);
+    }
+    mButtonHash.clear();
+
+    return buttons;
 }
 
 /************************************************
@@ -157,13 +227,13 @@ LXQtTaskButton * LXQtTaskGroup::getNextPrevChildButton(bool next, bool circular)
         if (next)
         {
             for (int i = 0; i < mPopup->count() && idx == -1; i++)
-                if (mPopup->itemAt(i)->widget()->isVisibleTo(mPopup))
+                if (!mPopup->itemAt(i)->widget()->isHidden())
                     idx = i;
         }
         else
         {
             for (int i = mPopup->count() - 1; i >= 0 && idx == -1; i--)
-                if (mPopup->itemAt(i)->widget()->isVisibleTo(mPopup))
+                if (!mPopup->itemAt(i)->widget()->isHidden())
                     idx = i;
         }
     }
@@ -178,7 +248,7 @@ LXQtTaskButton * LXQtTaskGroup::getNextPrevChildButton(bool next, bool circular)
     if (item)
     {
         button = qobject_cast<LXQtTaskButton*>(item->widget());
-        if (button->isVisibleTo(mPopup))
+        if (!button->isHidden())
             return button;
     }
 
@@ -284,7 +354,7 @@ int LXQtTaskGroup::visibleButtonsCount() const
 {
     int i = 0;
     for (LXQtTaskButton *btn : qAsConst(mButtonHash))
-        if (btn->isVisibleTo(mPopup))
+        if (!btn->isHidden())
             i++;
     return i;
 }
@@ -325,7 +395,7 @@ void LXQtTaskGroup::regroup()
         LXQtTaskButton * button = nullptr;
         for (LXQtTaskButton *btn : qAsConst(mButtonHash))
         {
-            if (btn->isVisibleTo(mPopup))
+            if (!btn->isHidden())
             {
                 button = btn;
                 break;
@@ -460,8 +530,11 @@ void LXQtTaskGroup::refreshIconsGeometry()
  ************************************************/
 QSize LXQtTaskGroup::recalculateFrameSize()
 {
+    // too many windows to show all the buttons, switch to the list
+    mPopup->setListMode(buttonsHeight() > maximumFrameHeight());
+
     int height = recalculateFrameHeight();
-    mPopup->setMaximumHeight(1000);
+    mPopup->setMaximumHeight(maximumFrameHeight());
     mPopup->setMinimumHeight(0);
 
     int hh = recalculateFrameWidth();
@@ -477,13 +550,29 @@ QSize LXQtTaskGroup::recalculateFrameSize()
 /************************************************
 
  ************************************************/
-int LXQtTaskGroup::recalculateFrameHeight() const
+int LXQtTaskGroup::buttonsHeight() const
 {
     int cont = visibleButtonsCount();
     int h = !plugin()->panel()->isHorizontal() && parentTaskBar()->isAutoRotate() ? width() : height();
     return cont * h + (cont + 1) * mPopup->spacing();
 }
 
+/************************************************
+
+ ************************************************/
+int LXQtTaskGroup::maximumFrameHeight() const
+{
+    return qMin(1000, screen()->availableGeometry().height() / 2);
+}
+
+/************************************************
+
+ ************************************************/
+int LXQtTaskGroup::recalculateFrameHeight() const
+{
+    return mPopup->isListMode() ? maximumFrameHeight() : buttonsHeight();
+}
+
 /************************************************
 
  ************************************************/
@@ -491,9 +580,10 @@ int LXQtTaskGroup::recalculateFrameWidth() const
 {
     const QFontMetrics fm = fontMetrics();
     int max = 100 * fm.horizontalAdvance(QLatin1Char(' ')); // elide after the max width
-    int txtWidth = 0;
-    for (LXQtTaskButton *btn : qAsConst(mButtonHash))
-        txtWidth = qMax(fm.horizontalAdvance(btn->text()), txtWidth);
+    // don't measure all the titles in the list mode
+    int txtWidth = mPopup->isListMode() ? max : 0;
+    for (auto i = mButtonHash.cbegin(), i_e = mButtonHash.cend(); txtWidth < max && i != i_e; ++i)
+        txtWidth = qMax(fm.horizontalAdvance((*i)->text()), txtWidth);
     return iconSize().width() + qMin(txtWidth, max) + 30/* give enough room to margins and borders*/;
 }
 
@@ -627,11 +717,11 @@ bool LXQtTaskGroup::onWindowChanged(WId window, NET::Properties prop, NET::Prope
 
     if (!buttons.isEmpty())
     {
-        // if class is changed the window won't belong to our group any more
-        if (parentTaskBar()->isGroupingEnabled() && prop2.testFlag(NET::WM2WindowClass))
+        if (prop2.testFlag(NET::WM2WindowClass))
         {
-            KWindowInfo info(window, NET::Properties(), NET::WM2WindowClass);
-            if (QString::fromUtf8(info.windowClassClass()) != mGroupName)
+            std::for_each(buttons.begin(), buttons.end(), std::mem_fn(&LXQtTaskButton::updateWindowClass));
+            // if class is changed the window won't belong to our group any more
+            if (parentTaskBar()->isGroupingEnabled() && buttons.first()->windowClass() != mGroupName)
             {
                 onWindowRemoved(window);
                 return false;
@@ -679,6 +769,10 @@ bool LXQtTaskGroup::onWindowChanged(WId window, NET::Properties prop, NET::Prope
         }
         if (set_urgency)
             std::for_each(buttons.begin(), buttons.end(), std::bind(&LXQtTaskButton::setUrgencyHint, std::placeholders::_1, urgency));
+
+        for (LXQtTaskButton * button : qAsConst(buttons))
+            if (button != this)
+                mPopup->buttonChanged(button);
     }
 
     if (needsRefreshVisibility)
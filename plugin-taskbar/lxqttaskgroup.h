@@ -50,6 +50,7 @@ class LXQtTaskGroup: public LXQtTaskButton
 
 public:
     LXQtTaskGroup(const QString & groupName, WId window, LXQtTaskBar * parent);
+    LXQtTaskGroup(const QString & groupName, LXQtTaskButton * button, LXQtTaskBar * parent);
 
     QString groupName() const { return mGroupName; }
 
@@ -57,6 +58,9 @@ public:
     int visibleButtonsCount() const;
 
     LXQtTaskButton * addWindow(WId id);
+    void addButtons(const QList<LXQtTaskButton *> & buttons);
+    // Detaches all buttons (in popup order) without destroying them, so they can be moved to other groups
+    QList<LXQtTaskButton *> takeButtons();
     LXQtTaskButton * checkedButton() const;
 
     // Returns the next or the previous button in the popup
@@ -84,6 +88,8 @@ protected:
     void mouseMoveEvent(QMouseEvent * event);
     void mouseReleaseEvent(QMouseEvent *event);
     void wheelEvent(QWheelEvent* event);
+    int buttonsHeight() const;
+    int maximumFrameHeight() const;
     int recalculateFrameHeight() const;
     int recalculateFrameWidth() const;
 
@@ -112,6 +118,8 @@ private:
     bool mPreventPopup;
     bool mSingleButton; //!< flag if this group should act as a "standard" button (no grouping or only one "shown" window in group)
 
+    void init();
+    void addButton(LXQtTaskButton * btn);
     QSize recalculateFrameSize();
     QPoint recalculateFramePosition();
     void recalculateFrameIfVisible();
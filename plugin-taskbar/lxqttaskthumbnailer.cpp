@@ -0,0 +1,538 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "lxqttaskthumbnailer.h"
+
+#include <QDebug>
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QRect>
+#include <QtConcurrent>
+#include <QX11Info>
+#include <KWindowSystem/KX11Extras>
+
+#include <xcb/composite.h>
+#include <xcb/shm.h>
+#include <xcb/xcb_event.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+namespace
+{
+    // budget for the downscaled thumbnails (in KiB)
+    const int THUMBNAIL_CACHE_BUDGET = 16 * 1024;
+    // the number of windows captured at the same time through shared memory
+    const int MAX_SHM_SEGMENTS = 2;
+
+    QImage downscale(const uchar *data, int width, int height, QImage::Format format, QSize const & size)
+    {
+        return QImage(data, width, height, width * 4, format).scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+}
+
+/************************************************
+ MIT-SHM segment attached to the X server. It is reused for
+ subsequent captures once the downscaling of its content finished.
+ ************************************************/
+struct LXQtTaskThumbnailer::ShmSegment
+{
+    ShmSegment(xcb_connection_t *c, size_t segmentSize)
+        : connection(c)
+        , size(segmentSize)
+    {
+        const int id = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+        if (id < 0)
+            return;
+
+        void *addr = shmat(id, nullptr, 0);
+        if (addr != reinterpret_cast<void *>(-1))
+        {
+            seg = xcb_generate_id(connection);
+            xcb_generic_error_t *error = xcb_request_check(connection, xcb_shm_attach_checked(connection, seg, id, false));
+            if (error)
+            {
+                free(error);
+                shmdt(addr);
+                seg = XCB_NONE;
+            }
+            else
+                data = static_cast<uchar *>(addr);
+        }
+        // the segment is destroyed once detached by both sides
+        shmctl(id, IPC_RMID, nullptr);
+    }
+
+    ~ShmSegment()
+    {
+        if (data)
+        {
+            xcb_shm_detach(connection, seg);
+            shmdt(data);
+        }
+    }
+
+    bool isValid() const { return data != nullptr; }
+
+    xcb_connection_t *connection;
+    size_t size;
+    xcb_shm_seg_t seg = XCB_NONE;
+    uchar *data = nullptr;
+    bool busy = false;
+};
+
+/************************************************
+
+ ************************************************/
+LXQtTaskThumbnailer::LXQtTaskThumbnailer(QObject *parent)
+    : QObject(parent)
+    , mConnection(QX11Info::connection())
+    , mAvailable(false)
+    , mShmAvailable(false)
+    , mDamageEventBase(0)
+    , mRefreshRate(10)
+    , mThumbnailSize(256, 256)
+    , mCache(THUMBNAIL_CACHE_BUDGET)
+{
+    mRefreshTimer.setSingleShot(true);
+    connect(&mRefreshTimer, &QTimer::timeout, this, &LXQtTaskThumbnailer::refresh);
+    setRefreshRate(mRefreshRate);
+
+    if (!mConnection)
+        return;
+
+    xcb_prefetch_extension_data(mConnection, &xcb_composite_id);
+    xcb_prefetch_extension_data(mConnection, &xcb_damage_id);
+    xcb_prefetch_extension_data(mConnection, &xcb_shm_id);
+
+    const auto *composite = xcb_get_extension_data(mConnection, &xcb_composite_id);
+    const auto *damage = xcb_get_extension_data(mConnection, &xcb_damage_id);
+    const auto *shm = xcb_get_extension_data(mConnection, &xcb_shm_id);
+    if (!composite || !composite->present || !damage || !damage->present)
+    {
+        qDebug() << "Window thumbnails need the composite and damage extensions";
+        return;
+    }
+
+    // named window pixmaps are available since composite 0.2
+    const auto compositeCookie = xcb_composite_query_version(mConnection, XCB_COMPOSITE_MAJOR_VERSION, XCB_COMPOSITE_MINOR_VERSION);
+    const auto damageCookie = xcb_damage_query_version(mConnection, XCB_DAMAGE_MAJOR_VERSION, XCB_DAMAGE_MINOR_VERSION);
+    xcb_composite_query_version_reply_t *compositeVersion = xcb_composite_query_version_reply(mConnection, compositeCookie, nullptr);
+    free(xcb_damage_query_version_reply(mConnection, damageCookie, nullptr));
+    mAvailable = compositeVersion && (compositeVersion->major_version > 0 || compositeVersion->minor_version >= 2);
+    free(compositeVersion);
+
+    if (mAvailable)
+    {
+        mDamageEventBase = damage->first_event;
+        mShmAvailable = shm && shm->present;
+        qApp->installNativeEventFilter(this);
+    }
+}
+
+/************************************************
+
+ ************************************************/
+LXQtTaskThumbnailer::~LXQtTaskThumbnailer()
+{
+    if (mAvailable)
+        qApp->removeNativeEventFilter(this);
+    for (auto i = mSources.cbegin(), i_e = mSources.cend(); i != i_e; ++i)
+    {
+        if (i->damage != XCB_NONE)
+            xcb_damage_destroy(mConnection, i->damage);
+    }
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskThumbnailer::isAvailable() const
+{
+    // without a compositing manager the windows are not redirected and there is no pixmap to capture
+    return mAvailable && KX11Extras::compositingActive();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::setRefreshRate(int fps)
+{
+    mRefreshRate = qBound(1, fps, 60);
+    mRefreshTimer.setInterval(1000 / mRefreshRate);
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::watch(WId window)
+{
+    if (!isAvailable() || mSources.contains(window))
+        return;
+
+    updateFrame(window, mSources[window]);
+    scheduleRefresh();
+}
+
+/************************************************
+ The compositing manager redirects only the direct children of
+ the root window. With a reparenting window manager it is the frame
+ holding the client window (and its decorations).
+ ************************************************/
+xcb_window_t LXQtTaskThumbnailer::topLevelFrame(xcb_window_t window) const
+{
+    while (true)
+    {
+        xcb_query_tree_reply_t *tree = xcb_query_tree_reply(mConnection, xcb_query_tree(mConnection, window), nullptr);
+        if (!tree)
+            return XCB_NONE;
+        const xcb_window_t parent = tree->parent;
+        const bool topLevel = parent == tree->root || parent == XCB_NONE;
+        free(tree);
+        if (topLevel)
+            return window;
+        window = parent;
+    }
+}
+
+/************************************************
+ \return true if the window got a new frame
+ ************************************************/
+bool LXQtTaskThumbnailer::updateFrame(WId window, Source & source)
+{
+    const xcb_window_t frame = topLevelFrame(window);
+    if (frame == source.frame)
+        return false;
+
+    if (source.damage != XCB_NONE)
+    {
+        xcb_damage_destroy(mConnection, source.damage);
+        source.damage = XCB_NONE;
+    }
+    mFrames.remove(source.frame);
+
+    source.frame = frame;
+    if (frame != XCB_NONE)
+    {
+        mFrames.insert(frame, window);
+        source.damage = xcb_generate_id(mConnection);
+        xcb_damage_create(mConnection, source.damage, frame, XCB_DAMAGE_REPORT_LEVEL_NON_EMPTY);
+    }
+    source.dirty = true;
+    return true;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::release(WId window)
+{
+    auto i = mSources.find(window);
+    if (i == mSources.end())
+        return;
+
+    if (i->damage != XCB_NONE)
+        xcb_damage_destroy(mConnection, i->damage);
+    mFrames.remove(i->frame);
+    mSources.erase(i);
+    mCache.remove(window);
+
+    if (mSources.isEmpty())
+    {
+        mRefreshTimer.stop();
+        // segments still used by a worker are freed when it finishes
+        mSegments.clear();
+    }
+}
+
+/************************************************
+
+ ************************************************/
+QImage LXQtTaskThumbnailer::thumbnail(WId window) const
+{
+    QImage *image = mCache.object(window);
+    return image ? *image : QImage{};
+}
+
+/************************************************
+
+ ************************************************/
+bool LXQtTaskThumbnailer::nativeEventFilter(const QByteArray &eventType, void *message, long *result)
+{
+    Q_UNUSED(result)
+
+    if (eventType != "xcb_generic_event_t" || mSources.isEmpty())
+        return false;
+
+    xcb_generic_event_t *ev = static_cast<xcb_generic_event_t *>(message);
+    if (XCB_EVENT_RESPONSE_TYPE(ev) == mDamageEventBase + XCB_DAMAGE_NOTIFY)
+    {
+        const auto *damageEvent = reinterpret_cast<xcb_damage_notify_event_t *>(ev);
+        auto i = mSources.find(mFrames.value(damageEvent->drawable));
+        if (i != mSources.end() && i->damage == damageEvent->damage)
+        {
+            xcb_damage_subtract(mConnection, i->damage, XCB_NONE, XCB_NONE);
+            i->dirty = true;
+            scheduleRefresh();
+        }
+    }
+
+    return false;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::scheduleRefresh()
+{
+    // all damage until the timeout is handled by one capture
+    if (!mRefreshTimer.isActive())
+        mRefreshTimer.start();
+}
+
+/************************************************
+
+ ************************************************/
+QSharedPointer<LXQtTaskThumbnailer::ShmSegment> LXQtTaskThumbnailer::acquireSegment(size_t size)
+{
+    for (auto const & segment : qAsConst(mSegments))
+    {
+        if (!segment->busy && segment->size >= size)
+            return segment;
+    }
+
+    // drop an unused (too small) segment to make place for the new one
+    for (auto i = mSegments.begin(); i != mSegments.end(); ++i)
+    {
+        if (!(*i)->busy)
+        {
+            mSegments.erase(i);
+            break;
+        }
+    }
+
+    if (mSegments.count() >= MAX_SHM_SEGMENTS)
+        return {};
+
+    QSharedPointer<ShmSegment> segment{new ShmSegment{mConnection, size}};
+    if (!segment->isValid())
+    {
+        qDebug() << "MIT-SHM not usable for window thumbnails, falling back to plain image transfer";
+        mShmAvailable = false;
+        return {};
+    }
+    mSegments.append(segment);
+    return segment;
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::refresh()
+{
+    struct Capture
+    {
+        WId window;
+        xcb_pixmap_t pixmap;
+        xcb_void_cookie_t nameCookie;
+        xcb_get_geometry_cookie_t geometryCookie;
+        xcb_get_geometry_cookie_t clientGeometryCookie;
+        xcb_translate_coordinates_cookie_t clientPosCookie;
+        int x = 0;
+        int y = 0;
+        int width = 0;
+        int height = 0;
+        QImage::Format format = QImage::Format_RGB32;
+        QSharedPointer<ShmSegment> segment;
+        xcb_shm_get_image_cookie_t shmCookie;
+        xcb_get_image_cookie_t imageCookie;
+    };
+
+    // all requests are sent before waiting for any of the replies, so
+    // capturing of all damaged windows costs only a few round trips
+    QList<Capture> captures;
+    for (auto i = mSources.begin(), i_e = mSources.end(); i != i_e; ++i)
+    {
+        if (!i->dirty || i->busy || i->frame == XCB_NONE)
+            continue;
+        Capture capture;
+        capture.window = i.key();
+        capture.pixmap = xcb_generate_id(mConnection);
+        // the pixmap must be named for each capture, it is replaced when the window gets resized
+        capture.nameCookie = xcb_composite_name_window_pixmap_checked(mConnection, i->frame, capture.pixmap);
+        capture.geometryCookie = xcb_get_geometry(mConnection, capture.pixmap);
+        // the decorations are cropped away
+        capture.clientGeometryCookie = xcb_get_geometry(mConnection, capture.window);
+        capture.clientPosCookie = xcb_translate_coordinates(mConnection, capture.window, i->frame, 0, 0);
+        captures.append(capture);
+    }
+
+    bool pending = false;
+    for (auto i = captures.begin(); i != captures.end(); )
+    {
+        xcb_generic_error_t *nameError = xcb_request_check(mConnection, i->nameCookie);
+        xcb_generic_error_t *geometryError = nullptr;
+        xcb_get_geometry_reply_t *geometry = xcb_get_geometry_reply(mConnection, i->geometryCookie, &geometryError);
+        xcb_get_geometry_reply_t *clientGeometry = xcb_get_geometry_reply(mConnection, i->clientGeometryCookie, nullptr);
+        xcb_translate_coordinates_reply_t *clientPos = xcb_translate_coordinates_reply(mConnection, i->clientPosCookie, nullptr);
+        const bool named = !nameError;
+        const bool valid = named && geometry && clientGeometry && clientPos
+            && (geometry->depth == 24 || geometry->depth == 32);
+        if (valid)
+        {
+            const QRect area = QRect{clientPos->dst_x, clientPos->dst_y, clientGeometry->width, clientGeometry->height}
+                & QRect{0, 0, geometry->width, geometry->height};
+            i->x = area.x();
+            i->y = area.y();
+            i->width = area.width();
+            i->height = area.height();
+            i->format = geometry->depth == 32 ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
+        }
+        free(nameError);
+        free(geometryError);
+        free(geometry);
+        free(clientGeometry);
+        free(clientPos);
+
+        if (!valid || i->width <= 0 || i->height <= 0)
+        {
+            Source & source = mSources[i->window];
+            source.dirty = false;
+            // the window could have been reparented in the meantime, otherwise it is
+            // e.g. a minimized (unmapped) window and the last thumbnail is kept
+            if (!named && updateFrame(i->window, source))
+                pending = true;
+            if (named)
+                xcb_free_pixmap(mConnection, i->pixmap);
+            i = captures.erase(i);
+            continue;
+        }
+
+        const size_t size = static_cast<size_t>(i->width) * i->height * 4;
+        if (mShmAvailable)
+        {
+            i->segment = acquireSegment(size);
+            if (!i->segment && mShmAvailable)
+            {
+                // all segments are in use, try it next time
+                xcb_free_pixmap(mConnection, i->pixmap);
+                pending = true;
+                i = captures.erase(i);
+                continue;
+            }
+        }
+
+        if (i->segment)
+        {
+            i->segment->busy = true;
+            i->shmCookie = xcb_shm_get_image(mConnection, i->pixmap, i->x, i->y, i->width, i->height, ~0, XCB_IMAGE_FORMAT_Z_PIXMAP, i->segment->seg, 0);
+        }
+        else
+            i->imageCookie = xcb_get_image(mConnection, XCB_IMAGE_FORMAT_Z_PIXMAP, i->pixmap, i->x, i->y, i->width, i->height, ~0);
+        // the image request is processed before the pixmap is freed
+        xcb_free_pixmap(mConnection, i->pixmap);
+        ++i;
+    }
+
+    for (Capture const & capture : qAsConst(captures))
+    {
+        Source & source = mSources[capture.window];
+        const QSize thumbnailSize = mThumbnailSize;
+        const WId window = capture.window;
+        const int width = capture.width;
+        const int height = capture.height;
+        const QImage::Format format = capture.format;
+        QFuture<QImage> future;
+
+        if (capture.segment)
+        {
+            xcb_shm_get_image_reply_t *reply = xcb_shm_get_image_reply(mConnection, capture.shmCookie, nullptr);
+            if (!reply)
+            {
+                capture.segment->busy = false;
+                source.dirty = false;
+                continue;
+            }
+            free(reply);
+            const uchar *data = capture.segment->data;
+            future = QtConcurrent::run([data, width, height, format, thumbnailSize] {
+                return downscale(data, width, height, format, thumbnailSize);
+            });
+        }
+        else
+        {
+            xcb_get_image_reply_t *reply = xcb_get_image_reply(mConnection, capture.imageCookie, nullptr);
+            if (!reply || xcb_get_image_data_length(reply) < width * height * 4)
+            {
+                free(reply);
+                source.dirty = false;
+                continue;
+            }
+            future = QtConcurrent::run([reply, width, height, format, thumbnailSize] {
+                QImage image = downscale(xcb_get_image_data(reply), width, height, format, thumbnailSize);
+                free(reply);
+                return image;
+            });
+        }
+
+        source.dirty = false;
+        source.busy = true;
+
+        auto *watcher = new QFutureWatcher<QImage>(this);
+        // the segment is held by the watcher until the worker is done with it
+        QSharedPointer<ShmSegment> segment = capture.segment;
+        connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, window, segment] {
+            if (segment)
+                segment->busy = false;
+            scaled(window, watcher->result());
+            watcher->deleteLater();
+        });
+        watcher->setFuture(future);
+    }
+
+    if (pending)
+        scheduleRefresh();
+}
+
+/************************************************
+
+ ************************************************/
+void LXQtTaskThumbnailer::scaled(WId window, QImage const & image)
+{
+    auto i = mSources.find(window);
+    // the window was released in the meantime
+    if (i == mSources.end())
+        return;
+
+    i->busy = false;
+    if (!image.isNull())
+    {
+        mCache.insert(window, new QImage{image}, qMax(1, static_cast<int>(image.sizeInBytes() / 1024)));
+        emit thumbnailChanged(window);
+    }
+
+    if (i->dirty)
+        scheduleRefresh();
+}
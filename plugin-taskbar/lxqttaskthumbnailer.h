@@ -0,0 +1,110 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#ifndef LXQTTASKTHUMBNAILER_H
+#define LXQTTASKTHUMBNAILER_H
+
+#include <QObject>
+#include <QAbstractNativeEventFilter>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QSharedPointer>
+#include <QSize>
+#include <QTimer>
+
+#include <xcb/xcb.h>
+#include <xcb/damage.h>
+
+/*! Provides live window thumbnails for the group popups.
+ *
+ * Windows are captured from their XComposite named pixmaps (through a MIT-SHM
+ * segment if available) and downscaled in a worker thread. With a reparenting
+ * window manager only the frame (the top-level window) is redirected, so the
+ * frame is captured and the image is cropped to the client window. Only watched
+ * windows are captured and they are recaptured only after XDamage reported
+ * a change, at most refreshRate() times per second. The downscaled images
+ * are kept in a cache limited by a memory budget.
+ */
+class LXQtTaskThumbnailer : public QObject, public QAbstractNativeEventFilter
+{
+    Q_OBJECT
+
+public:
+    explicit LXQtTaskThumbnailer(QObject *parent = nullptr);
+    ~LXQtTaskThumbnailer() override;
+
+    //! \return true if the X server and the window manager allow capturing of windows
+    bool isAvailable() const;
+
+    int refreshRate() const { return mRefreshRate; }
+    void setRefreshRate(int fps);
+
+    //! Starts tracking (and capturing) the window until release() is called
+    void watch(WId window);
+    //! Stops tracking the window and frees all the X resources held for it
+    void release(WId window);
+
+    //! \return the last captured thumbnail or a null image
+    QImage thumbnail(WId window) const;
+
+signals:
+    void thumbnailChanged(WId window);
+
+protected:
+    bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override;
+
+private:
+    struct ShmSegment;
+    struct Source
+    {
+        xcb_window_t frame = XCB_NONE; //!< the redirected top-level window
+        xcb_damage_damage_t damage = XCB_NONE;
+        bool dirty = true;
+        bool busy = false; //!< downscaling in progress
+    };
+
+    xcb_window_t topLevelFrame(xcb_window_t window) const;
+    bool updateFrame(WId window, Source & source);
+    void scheduleRefresh();
+    void refresh();
+    QSharedPointer<ShmSegment> acquireSegment(size_t size);
+    void scaled(WId window, QImage const & image);
+
+    xcb_connection_t *mConnection;
+    bool mAvailable;
+    bool mShmAvailable;
+    uint8_t mDamageEventBase;
+    int mRefreshRate;
+    QSize mThumbnailSize;
+    QHash<WId, Source> mSources;
+    QHash<xcb_window_t, WId> mFrames;
+    QList<QSharedPointer<ShmSegment>> mSegments;
+    QCache<WId, QImage> mCache;
+    QTimer mRefreshTimer;
+};
+
+#endif // LXQTTASKTHUMBNAILER_H
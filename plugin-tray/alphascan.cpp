@@ -0,0 +1,178 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2.1+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#include "alphascan.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define ALPHASCAN_X86
+#endif
+
+namespace
+{
+// first/last pixel with non-zero alpha in [from, to) of a row, -1 if there is none
+using ScanFunction = int (*)(const quint32 *, int, int);
+
+int firstScalar(const quint32 *line, int from, int to)
+{
+    for (int x = from; x < to; ++x) {
+        if (line[x] >> 24) {
+            return x;
+        }
+    }
+    return -1;
+}
+
+int lastScalar(const quint32 *line, int from, int to)
+{
+    for (int x = to - 1; x >= from; --x) {
+        if (line[x] >> 24) {
+            return x;
+        }
+    }
+    return -1;
+}
+
+#if defined(ALPHASCAN_X86)
+// bit i set for each of the 4 pixels with non-zero alpha
+__attribute__((target("sse2"))) inline unsigned opaqueLanesSse2(const quint32 *p)
+{
+    const __m128i alpha = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), _mm_set1_epi32(static_cast<int>(0xff000000)));
+    return ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(alpha, _mm_setzero_si128()))) & 0xf;
+}
+
+__attribute__((target("sse2"))) int firstSse2(const quint32 *line, int from, int to)
+{
+    int x = from;
+    for (; x + 4 <= to; x += 4) {
+        if (const unsigned lanes = opaqueLanesSse2(line + x)) {
+            return x + __builtin_ctz(lanes);
+        }
+    }
+    return firstScalar(line, x, to);
+}
+
+__attribute__((target("sse2"))) int lastSse2(const quint32 *line, int from, int to)
+{
+    int x = to;
+    for (; x - 4 >= from; x -= 4) {
+        if (const unsigned lanes = opaqueLanesSse2(line + x - 4)) {
+            return x - 4 + 31 - __builtin_clz(lanes);
+        }
+    }
+    return lastScalar(line, from, x);
+}
+
+// bit i set for each of the 8 pixels with non-zero alpha
+__attribute__((target("avx2"))) inline unsigned opaqueLanesAvx2(const quint32 *p)
+{
+    const __m256i alpha =
+        _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)), _mm256_set1_epi32(static_cast<int>(0xff000000)));
+    return ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(alpha, _mm256_setzero_si256()))) & 0xff;
+}
+
+__attribute__((target("avx2"))) int firstAvx2(const quint32 *line, int from, int to)
+{
+    int x = from;
+    for (; x + 8 <= to; x += 8) {
+        if (const unsigned lanes = opaqueLanesAvx2(line + x)) {
+            return x + __builtin_ctz(lanes);
+        }
+    }
+    // not calling the SSE2 variant, mixing it with AVX would stall
+    if (x + 4 <= to) {
+        if (const unsigned lanes = opaqueLanesSse2(line + x)) {
+            return x + __builtin_ctz(lanes);
+        }
+        x += 4;
+    }
+    return firstScalar(line, x, to);
+}
+
+__attribute__((target("avx2"))) int lastAvx2(const quint32 *line, int from, int to)
+{
+    int x = to;
+    for (; x - 8 >= from; x -= 8) {
+        if (const unsigned lanes = opaqueLanesAvx2(line + x - 8)) {
+            return x - 8 + 31 - __builtin_clz(lanes);
+        }
+    }
+    if (x - 4 >= from) {
+        if (const unsigned lanes = opaqueLanesSse2(line + x - 4)) {
+            return x - 4 + 31 - __builtin_clz(lanes);
+        }
+        x -= 4;
+    }
+    return lastScalar(line, from, x);
+}
+#endif
+
+struct Scanner {
+    ScanFunction first;
+    ScanFunction last;
+};
+
+Scanner selectScanner()
+{
+#if defined(ALPHASCAN_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return {firstAvx2, lastAvx2};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return {firstSse2, lastSse2};
+    }
+#endif
+    return {firstScalar, lastScalar};
+}
+} // namespace
+
+QRect opaqueArea(const uchar *bits, int width, int height, qsizetype bytesPerLine)
+{
+    static const Scanner scanner = selectScanner();
+
+    int left = width, right = -1, top = -1, bottom = -1;
+    for (int y = 0; y < height; ++y) {
+        const quint32 *line = reinterpret_cast<const quint32 *>(bits + y * bytesPerLine);
+        // a transparent row is scanned once, otherwise only the parts
+        // outside of the known area are scanned from both ends
+        const int first = scanner.first(line, 0, width);
+        if (first < 0) {
+            continue;
+        }
+        if (top < 0) {
+            top = y;
+        }
+        bottom = y;
+        left = qMin(left, first);
+        const int last = scanner.last(line, qMax(first, right + 1), width);
+        right = qMax(right, last);
+    }
+
+    if (top < 0) {
+        return QRect{};
+    }
+    return QRect{QPoint{left, top}, QPoint{right, bottom}};
+}
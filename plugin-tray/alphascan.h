@@ -0,0 +1,37 @@
+/* BEGIN_COMMON_COPYRIGHT_HEADER
+ * (c)LGPL2.1+
+ *
+ * LXQt - a lightweight, Qt based, desktop toolset
+ * https://lxqt.org
+ *
+ * Copyright: 2026 LXQt team
+ *
+ * This program or library is free software; you can redistribute it
+ * and/or modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA
+ *
+ * END_COMMON_COPYRIGHT_HEADER */
+
+#pragma once
+
+#include <QRect>
+#include <QtGlobal>
+
+/**
+ * Scans the alpha channel of 32-bit ARGB pixels row by row, using SSE2/AVX2
+ * when the CPU supports it.
+ * @return the bounding rectangle of the pixels with non-zero alpha,
+ * a null rectangle if all pixels are transparent
+ */
+QRect opaqueArea(const uchar *bits, int width, int height, qsizetype bytesPerLine);
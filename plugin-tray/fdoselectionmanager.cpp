@@ -161,7 +161,7 @@ bool FdoSelectionManager::nativeEventFilter(const QByteArray &eventType, void *m
         const auto damagedWId = reinterpret_cast<xcb_damage_notify_event_t *>(ev)->drawable;
         const auto sniProxy = m_proxies.value(damagedWId);
         if (sniProxy) {
-            sniProxy->update();
+            sniProxy->scheduleUpdate();
             xcb_damage_subtract(QX11Info::connection(), m_damageWatches[damagedWId], XCB_NONE, XCB_NONE);
         }
     } else if (responseType == XCB_CONFIGURE_REQUEST) {
@@ -28,11 +28,17 @@
 #include "sniproxy.h"
 
 #include <algorithm>
+#include <cstring>
+#include <sys/ipc.h>
+#include <sys/shm.h>
 #include <xcb/xcb_atom.h>
 #include <xcb/xcb_event.h>
+#include <xcb/xcbext.h>
 
 #include "xcbutils.h"
 
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
 #include <QDebug>
 #include <QGuiApplication>
 #include <QScreen>
@@ -47,6 +53,7 @@
 #include "statusnotifieritemadaptor.h"
 #include "statusnotifierwatcher_interface.h"
 
+#include "alphascan.h"
 #include "xtestsender.h"
 
 //#define VISUAL_DEBUG
@@ -56,8 +63,10 @@
 
 static uint16_t s_embedSize = 128; // size of window to embed
 static unsigned int XEMBED_VERSION = 0;
+static const int s_frameInterval = 16; // ms, at most one capture per frame
+static const int s_captureTimeout = 100; // ms, block on the replies after that
 
-int SNIProxy::s_serviceCount = 0;
+int SNIProxy::s_proxyCount = 0;
 
 void xembed_message_send(Xcb::Atoms & atoms, xcb_window_t towin, long message, long d1, long d2, long d3)
 {
@@ -75,34 +84,99 @@ void xembed_message_send(Xcb::Atoms & atoms, xcb_window_t towin, long message, l
     xcb_send_event(QX11Info::connection(), false, towin, XCB_EVENT_MASK_NO_EVENT, (char *)&ev);
 }
 
-static QRect findOpaqueArea(const QImage & image, int margin = 0)
-{
-    int w = image.width();
-    int h = image.height();
-    int left = image.width(), right = 0, top = image.height(), bottom = 0;
-    for (int x = 0; x < w; ++x) {
-        for (int y = 0; y < h; ++y) {
-            if (qAlpha(image.pixel(x, y))) {
-                // Found an opaque pixel.
-                if (x < left) left = x;
-                if (x > right) right = x;
-                if (y < top) top = y;
-                if (y > bottom) bottom = y;
-            }
+static QRect findOpaqueArea(const QImage & image)
+{
+    if (image.isNull()) {
+        return QRect{};
+    }
+    if (image.depth() != 32) {
+        return findOpaqueArea(image.convertToFormat(QImage::Format_ARGB32));
+    }
+    return opaqueArea(image.constBits(), image.width(), image.height(), image.bytesPerLine());
+}
+
+static bool clearChanged(uchar *data, int size)
+{
+    bool changed = false;
+    for (int i = 0; i < size; ++i) {
+        changed |= data[i] != 0;
+    }
+    if (changed) {
+        memset(data, 0, size);
+    }
+    return changed;
+}
+
+static bool copyChanged(uchar *data, const uchar *source, int size)
+{
+    if (memcmp(data, source, size) == 0) {
+        return false;
+    }
+    memcpy(data, source, size);
+    return true;
+}
+
+/*
+  Copies the area of the image into the target, reusing the target's buffer if
+  nothing else refers to it. Like QImage::copy(), the pixels outside of the
+  image are transparent.
+  Returns false if the target already had the very same pixels.
+*/
+static bool copyArea(const QImage & image, const QRect & area, QImage & target)
+{
+    if (image.depth() < 8 || target.size() != area.size() || target.format() != image.format() || !target.isDetached()) {
+        target = image.copy(area);
+        return true;
+    }
+
+    bool changed = false;
+    const QRect r = area.intersected(image.rect());
+    const int bytes = image.depth() / 8;
+    const int lineBytes = area.width() * bytes;
+    for (int y = area.top(); y <= area.bottom(); ++y) {
+        uchar *line = target.scanLine(y - area.top());
+        if (r.isEmpty() || y < r.top() || y > r.bottom()) {
+            changed |= clearChanged(line, lineBytes);
+            continue;
         }
+        const int before = (r.left() - area.left()) * bytes;
+        const int inside = r.width() * bytes;
+        changed |= clearChanged(line, before);
+        changed |= copyChanged(line + before, image.constScanLine(y) + r.left() * bytes, inside);
+        changed |= clearChanged(line + before + inside, lineBytes - before - inside);
     }
+    return changed;
+}
 
-    QRect r{QPoint{left - margin, top - margin}, QPoint{right + margin, bottom + margin}};
-    return r;
+/*
+  Takes the reply of a pending request without blocking, unless asked to.
+  Returns false if the reply hasn't arrived yet. An error gives a null reply.
+*/
+template<typename Reply, typename Cookie>
+static bool takeReply(xcb_connection_t *c, Cookie cookie, Reply *(*replyFunc)(xcb_connection_t *, Cookie, xcb_generic_error_t **), bool block,
+                      QScopedPointer<Reply, QScopedPointerPodDeleter> &reply)
+{
+    if (block) {
+        reply.reset(replyFunc(c, cookie, nullptr));
+        return true;
+    }
+    void *data = nullptr;
+    xcb_generic_error_t *error = nullptr;
+    if (!xcb_poll_for_reply(c, cookie.sequence, &data, &error)) {
+        return false;
+    }
+    free(error);
+    reply.reset(static_cast<Reply *>(data));
+    return true;
 }
 
 SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
     : QObject(parent)
     ,
-    // Work round a bug in our SNIWatcher with multiple SNIs per connection.
-    // there is an undocumented feature that you can register an SNI by path, however it doesn't detect an object on a service being removed, only the entire
-    // service closing instead lets use one DBus connection per SNI
-    m_dbus(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy%1").arg(s_serviceCount++)))
+    // all proxies share one connection and register their SNI by path,
+    // our watcher is told about each SNI going away by UnregisterStatusNotifierItem
+    m_dbus(QDBusConnection::connectToBus(QDBusConnection::SessionBus, QStringLiteral("XembedSniProxy")))
+    , m_dbusPath(QStringLiteral("/StatusNotifierItem/%1").arg(wid))
     , m_windowId(wid)
     , sendingClickEvent(false)
     , m_injectMode(Direct)
@@ -110,17 +184,25 @@ SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
 {
     resizeWindow(s_embedSize, s_embedSize);
 
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(s_frameInterval);
+    connect(&m_updateTimer, &QTimer::timeout, this, &SNIProxy::frameTick);
+
     // create new SNI
     new StatusNotifierItemAdaptor(this);
-    m_dbus.registerObject(QStringLiteral("/StatusNotifierItem"), this);
+    ++s_proxyCount;
+    m_dbus.registerObject(m_dbusPath, this);
 
+    // the watcher takes the service of a path from the sender, so call it through the shared connection
     auto statusNotifierWatcher =
-        new org::kde::StatusNotifierWatcher(QStringLiteral(SNI_WATCHER_SERVICE_NAME), QStringLiteral(SNI_WATCHER_PATH), QDBusConnection::sessionBus(), this);
-    auto reply = statusNotifierWatcher->RegisterStatusNotifierItem(m_dbus.baseService());
-    reply.waitForFinished();
-    if (reply.isError()) {
-        qWarning() << "could not register SNI:" << reply.error().message();
-    }
+        new org::kde::StatusNotifierWatcher(QStringLiteral(SNI_WATCHER_SERVICE_NAME), QStringLiteral(SNI_WATCHER_PATH), m_dbus, this);
+    auto watcher = new QDBusPendingCallWatcher(statusNotifierWatcher->RegisterStatusNotifierItem(m_dbusPath), this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this, [](QDBusPendingCallWatcher *call) {
+        call->deleteLater();
+        if (call->isError()) {
+            qWarning() << "could not register SNI:" << call->error().message();
+        }
+    });
 
     auto c = QX11Info::connection();
 
@@ -192,6 +274,8 @@ SNIProxy::SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent)
     xcb_configure_window(c, m_windowId, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, windowMoveConfigVals);
 
     QSize clientWindowSize = calculateClientWindowSize();
+    m_captureSize = clientWindowSize;
+    attachShm();
 
     // show the embedded window otherwise nothing happens
     xcb_map_window(c, m_windowId);
@@ -223,27 +307,208 @@ SNIProxy::~SNIProxy()
 {
     auto c = QX11Info::connection();
 
+    if (m_capturePending) {
+        if (!m_geometryDone) {
+            xcb_discard_reply(c, m_geometryCookie.sequence);
+        }
+        if (!m_imageDone) {
+            xcb_discard_reply(c, m_shmSeg ? m_shmImageCookie.sequence : m_imageCookie.sequence);
+        }
+    }
+    detachShm();
     if (!m_vanished) {
         xcb_reparent_window(c, m_windowId, QX11Info::appRootWindow(), 0, 0);
     }
     xcb_destroy_window(c, m_containerWid);
-    QDBusConnection::disconnectFromBus(m_dbus.name());
+
+    m_dbus.unregisterObject(m_dbusPath);
+    // no need to wait for the reply
+    m_dbus.send(QDBusMessage::createMethodCall(QStringLiteral(SNI_WATCHER_SERVICE_NAME),
+                                               QStringLiteral(SNI_WATCHER_PATH),
+                                               QStringLiteral(SNI_WATCHER_SERVICE_NAME),
+                                               QStringLiteral("UnregisterStatusNotifierItem"))
+                << m_dbusPath);
+    if (--s_proxyCount == 0) {
+        QDBusConnection::disconnectFromBus(m_dbus.name());
+    }
 }
 
 void SNIProxy::update()
 {
-    m_windowImage = getImageNonComposite();
+    if (m_capturePending) {
+        m_captureAgain = true;
+        collectCapture();
+        return;
+    }
+    m_updateTimer.stop();
+
+    auto c = QX11Info::connection();
+
+    // request the geometry together with the image of the last known size,
+    // the image is requested again in case the size has changed meanwhile
+    m_geometryCookie = xcb_get_geometry(c, m_windowId);
+    if (m_shmSeg) {
+        m_shmImageCookie = xcb_shm_get_image(c, m_windowId, 0, 0, m_captureSize.width(), m_captureSize.height(), 0xFFFFFFFF, XCB_IMAGE_FORMAT_Z_PIXMAP, m_shmSeg, 0);
+    } else {
+        m_imageCookie = xcb_get_image(c, XCB_IMAGE_FORMAT_Z_PIXMAP, m_windowId, 0, 0, m_captureSize.width(), m_captureSize.height(), 0xFFFFFFFF);
+    }
+    xcb_flush(c);
+
+    m_geometryDone = m_imageDone = false;
+    m_capturePending = true;
+    m_captureTime.start();
+    // the replies are collected on the next damage or frame tick, whichever comes first
+    m_updateTimer.start();
+}
+
+void SNIProxy::scheduleUpdate()
+{
+    if (m_capturePending) {
+        m_captureAgain = true;
+        collectCapture();
+    } else if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+void SNIProxy::frameTick()
+{
+    if (m_capturePending) {
+        collectCapture();
+    } else {
+        update();
+    }
+}
+
+void SNIProxy::collectCapture()
+{
+    auto c = QX11Info::connection();
+
+    // don't wait for a stuck X server forever, block on the replies as a last resort
+    const bool block = m_captureTime.elapsed() > s_captureTimeout;
+    if (!m_geometryDone) {
+        m_geometryDone = takeReply(c, m_geometryCookie, &xcb_get_geometry_reply, block, m_geometryReply);
+    }
+    if (!m_imageDone) {
+        m_imageDone = m_shmSeg ? takeReply(c, m_shmImageCookie, &xcb_shm_get_image_reply, block, m_shmImageReply)
+                               : takeReply(c, m_imageCookie, &xcb_get_image_reply, block, m_imageReply);
+    }
+    if (!m_geometryDone || !m_imageDone) {
+        if (!m_updateTimer.isActive()) {
+            m_updateTimer.start();
+        }
+        return;
+    }
+
+    m_capturePending = false;
+    m_updateTimer.stop();
+    finishCapture();
+
+    if (m_captureAgain) {
+        m_captureAgain = false;
+        scheduleUpdate();
+    }
+}
+
+void SNIProxy::finishCapture()
+{
+    QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter> clientGeom(m_geometryReply.take());
+    QScopedPointer<xcb_shm_get_image_reply_t, QScopedPointerPodDeleter> shmReply(m_shmImageReply.take());
+    xcb_get_image_reply_t *imageReply = m_imageReply.take();
+
+    QSize clientWindowSize;
+    if (clientGeom) {
+        clientWindowSize = QSize(clientGeom->width, clientGeom->height);
+    }
+    clientWindowSize = fitClientWindowSize(clientWindowSize);
+    if (clientWindowSize != m_captureSize) {
+        // the image doesn't match the window anymore, capture it again
+        free(imageReply);
+        m_captureSize = clientWindowSize;
+        m_captureAgain = true;
+        return;
+    }
+
+    xcb_image_t *image = nullptr;
+    if (shmReply) {
+        // the pixels stay in the shared segment, only the header is allocated
+        image = xcb_image_create_native(QX11Info::connection(), clientWindowSize.width(), clientWindowSize.height(), XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                        shmReply->depth, nullptr, shmReply->size, m_shmData);
+    } else if (imageReply) {
+        // the image takes the ownership of the reply, as in xcb_image_get()
+        image = xcb_image_create_native(QX11Info::connection(), clientWindowSize.width(), clientWindowSize.height(), XCB_IMAGE_FORMAT_Z_PIXMAP,
+                                        imageReply->depth, imageReply, xcb_get_image_data_length(imageReply), xcb_get_image_data(imageReply));
+        if (!image) {
+            free(imageReply);
+        }
+    }
+
+    QRect opaqueArea;
+    m_windowImage = getImageNonComposite(image, opaqueArea);
     if (m_windowImage.isNull()) {
         m_iconImage = QImage{};
+        m_iconPixmap.clear();
         qDebug() << "No xembed icon for" << m_windowId << Title();
         return;
     }
-    m_iconImage = m_windowImage.copy(findOpaqueArea(m_windowImage, 1));
+    // hosts reload all the pixmaps on NewIcon, don't make them do so for the same pixels
+    if (copyArea(m_windowImage, opaqueArea.adjusted(-1, -1, 1, 1), m_iconImage)) {
+        m_iconPixmap.clear();
+        Q_EMIT NewIcon();
+    }
     //qDebug() << Title() << "windowImage.size:" << m_windowImage.size() << ", iconImage.size:" << m_iconImage.size();
-    Q_EMIT NewIcon();
     Q_EMIT NewToolTip();
 }
 
+void SNIProxy::attachShm()
+{
+    auto c = QX11Info::connection();
+
+    const auto *reply = xcb_get_extension_data(c, &xcb_shm_id);
+    if (!reply || !reply->present) {
+        return;
+    }
+
+    // big enough for any capture, the window is never larger than s_embedSize
+    const int shmId = shmget(IPC_PRIVATE, s_embedSize * s_embedSize * 4, IPC_CREAT | 0600);
+    if (shmId < 0) {
+        return;
+    }
+    void *data = shmat(shmId, nullptr, 0);
+    if (data == reinterpret_cast<void *>(-1)) {
+        shmctl(shmId, IPC_RMID, nullptr);
+        return;
+    }
+
+    const xcb_shm_seg_t seg = xcb_generate_id(c);
+    QScopedPointer<xcb_generic_error_t, QScopedPointerPodDeleter> error(xcb_request_check(c, xcb_shm_attach_checked(c, seg, shmId, false)));
+    // the segment goes away once both we and the X server have detached
+    shmctl(shmId, IPC_RMID, nullptr);
+    if (error) {
+        // e.g. a remote X server, capture through the socket
+        qDebug() << "MIT-SHM not usable for" << m_windowId;
+        shmdt(data);
+        return;
+    }
+
+    m_shmSeg = seg;
+    m_shmData = static_cast<uchar *>(data);
+}
+
+void SNIProxy::detachShm()
+{
+    if (!m_shmSeg) {
+        return;
+    }
+
+    // the captured window image may point into the segment
+    m_windowImage = QImage{};
+    xcb_shm_detach(QX11Info::connection(), m_shmSeg);
+    shmdt(m_shmData);
+    m_shmSeg = XCB_NONE;
+    m_shmData = nullptr;
+}
+
 void SNIProxy::resizeWindow(const uint16_t width, const uint16_t height) const
 {
     auto connection = QX11Info::connection();
@@ -273,6 +538,11 @@ QSize SNIProxy::calculateClientWindowSize() const
     if (clientGeom) {
         clientWindowSize = QSize(clientGeom->width, clientGeom->height);
     }
+    return fitClientWindowSize(clientWindowSize);
+}
+
+QSize SNIProxy::fitClientWindowSize(QSize clientWindowSize) const
+{
     // if the window is a clearly stupid size resize to be something sensible
     // this is needed as chromium and such when resized just fill the icon with transparent space and only draw in the middle
     // however KeePass2 does need this as by default the window size is 273px wide and is not transparent
@@ -293,54 +563,28 @@ void sni_cleanup_xcb_image(void *data)
     xcb_image_destroy(static_cast<xcb_image_t *>(data));
 }
 
-bool SNIProxy::isTransparentImage(const QImage &image) const
+QImage SNIProxy::getImageNonComposite(xcb_image_t *image, QRect &opaqueArea) const
 {
-    int w = image.width();
-    int h = image.height();
-
-    // check for the center and sub-center pixels first and avoid full image scan
-    if (!(qAlpha(image.pixel(w >> 1, h >> 1)) + qAlpha(image.pixel(w >> 2, h >> 2)) == 0))
-        return false;
-
-    // skip scan altogether if sub-center pixel found to be opaque
-    // and break out from the outer loop too on full scan
-    for (int x = 0; x < w; ++x) {
-        for (int y = 0; y < h; ++y) {
-            if (qAlpha(image.pixel(x, y))) {
-                // Found an opaque pixel.
-                return false;
-            }
-        }
-    }
-
-    return true;
-}
-
-QImage SNIProxy::getImageNonComposite() const
-{
-    auto c = QX11Info::connection();
-
-    QSize clientWindowSize = calculateClientWindowSize();
-
-    xcb_image_t *image = xcb_image_get(c, m_windowId, 0, 0, clientWindowSize.width(), clientWindowSize.height(), 0xFFFFFFFF, XCB_IMAGE_FORMAT_Z_PIXMAP);
-
     // Don't hook up cleanup yet, we may use a different QImage after all
     QImage naiveConversion;
     if (image) {
         naiveConversion = QImage(image->data, image->width, image->height, QImage::Format_ARGB32);
     } else {
-        qDebug() << "Skip NULL image returned from xcb_image_get() for" << m_windowId << Title();
+        qDebug() << "Skip NULL image captured for" << m_windowId << Title();
         return QImage();
     }
 
-    if (isTransparentImage(naiveConversion)) {
+    // one scan tells whether the image is transparent and where the icon is
+    opaqueArea = findOpaqueArea(naiveConversion);
+    if (opaqueArea.isNull()) {
         QImage elaborateConversion = QImage(convertFromNative(image));
 
         // Update icon only if it is at least partially opaque.
         // This is just a workaround for X11 bug: xembed icon may suddenly
         // become transparent for a one or few frames. Reproducible at least
         // with WINE applications.
-        if (isTransparentImage(elaborateConversion)) {
+        opaqueArea = findOpaqueArea(elaborateConversion);
+        if (opaqueArea.isNull()) {
             qDebug() << "Skip transparent xembed icon for" << m_windowId << Title();
             return QImage();
         } else
@@ -476,6 +720,11 @@ QString SNIProxy::Id() const
 
 KDbusImageVector SNIProxy::IconPixmap() const
 {
+    // scaled and converted to the D-Bus layout once per icon, hosts may read it repeatedly
+    if (!m_iconPixmap.isEmpty()) {
+        return m_iconPixmap;
+    }
+
     KDbusImageVector v{m_iconImage};
     // add pixmaps up to s_embedSize resolution (for the SNI presenter to be able to choose, if needed)
     for (int s = 16; s <= s_embedSize && !m_iconImage.isNull(); s <<= 1)
@@ -485,6 +734,7 @@ KDbusImageVector SNIProxy::IconPixmap() const
             v << m_iconImage.scaled(s, s, Qt::KeepAspectRatio, Qt::SmoothTransformation);
         }
     }
+    m_iconPixmap = v;
     return v;
 }
 
@@ -30,12 +30,16 @@
 #include <QDBusArgument>
 #include <QDBusConnection>
 #include <QDBusObjectPath>
+#include <QElapsedTimer>
 #include <QObject>
 #include <QImage>
 #include <QPoint>
+#include <QScopedPointer>
+#include <QTimer>
 
 #include <xcb/xcb.h>
 #include <xcb/xcb_image.h>
+#include <xcb/shm.h>
 
 #include "snidbus.h"
 
@@ -58,7 +62,16 @@ public:
     explicit SNIProxy(xcb_window_t wid, Xcb::Atoms & atoms, QObject *parent = nullptr);
     ~SNIProxy() override;
 
+    /**
+     * Requests a new capture of the embedded window, the icon is updated
+     * once the X server has replied
+     */
     void update();
+    /**
+     * Coalesces the damage of the embedded window, at most one capture
+     * is requested per frame interval
+     */
+    void scheduleUpdate();
     void resizeWindow(const uint16_t width, const uint16_t height) const;
     void hideContainerWindow(xcb_window_t windowId) const;
     inline void vanished(bool vanished) { m_vanished = vanished; }
@@ -160,21 +173,46 @@ private:
     };
 
     QSize calculateClientWindowSize() const;
+    QSize fitClientWindowSize(QSize clientWindowSize) const;
+    void attachShm();
+    void detachShm();
+    void frameTick();
+    void collectCapture();
+    void finishCapture();
     void sendClick(uint8_t mouseButton, int x, int y);
-    QImage getImageNonComposite() const;
-    bool isTransparentImage(const QImage &image) const;
+    QImage getImageNonComposite(xcb_image_t *image, QRect &opaqueArea) const;
     QImage convertFromNative(xcb_image_t *xcbImage) const;
     QPoint calculateClickPoint() const;
     void stackContainerWindow(const uint32_t stackMode) const;
 
     QDBusConnection m_dbus;
+    QString m_dbusPath;
     xcb_window_t m_windowId;
     xcb_window_t m_containerWid;
-    static int s_serviceCount;
+    static int s_proxyCount;
     QImage m_windowImage;
     QImage m_iconImage;
+    mutable KDbusImageVector m_iconPixmap; // IconPixmap of m_iconImage, empty if outdated
     bool sendingClickEvent;
     InjectMode m_injectMode;
     Xcb::Atoms & m_atoms;
     bool m_vanished = false;
+
+    // asynchronous capture of the embedded window
+    QTimer m_updateTimer;
+    QElapsedTimer m_captureTime; //!< since the capture was requested
+    QSize m_captureSize;
+    xcb_get_geometry_cookie_t m_geometryCookie;
+    xcb_get_image_cookie_t m_imageCookie;
+    QScopedPointer<xcb_get_geometry_reply_t, QScopedPointerPodDeleter> m_geometryReply;
+    QScopedPointer<xcb_get_image_reply_t, QScopedPointerPodDeleter> m_imageReply;
+    // MIT-SHM segment the embedded window is captured into, if available
+    xcb_shm_seg_t m_shmSeg = XCB_NONE;
+    uchar *m_shmData = nullptr;
+    xcb_shm_get_image_cookie_t m_shmImageCookie;
+    QScopedPointer<xcb_shm_get_image_reply_t, QScopedPointerPodDeleter> m_shmImageReply;
+    bool m_geometryDone = false;
+    bool m_imageDone = false;
+    bool m_capturePending = false;
+    bool m_captureAgain = false;
 };